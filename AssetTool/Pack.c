@@ -0,0 +1,208 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "Pack.h"
+
+typedef struct FreeRect
+{
+	int x;
+	int y;
+	int width;
+	int height;
+}FreeRect;
+
+typedef struct PackPage
+{
+	FreeRect* free;
+	int count;
+	int capacity;
+}PackPage;
+
+static bool AddFree(PackPage* const _page, FreeRect _rect)
+{
+	if (_page->count == _page->capacity)
+	{
+		int capacity = _page->capacity ? _page->capacity * 2 : 64;
+		FreeRect* free = realloc(_page->free, capacity * sizeof(FreeRect));
+		if (!free)
+		{
+			return false;
+		}
+		_page->free = free;
+		_page->capacity = capacity;
+	}
+	_page->free[_page->count++] = _rect;
+	return true;
+}
+
+static bool Contains(FreeRect _outer, FreeRect _inner)
+{
+	return _inner.x >= _outer.x && _inner.y >= _outer.y
+		&& _inner.x + _inner.width <= _outer.x + _outer.width && _inner.y + _inner.height <= _outer.y + _outer.height;
+}
+
+// Best short side fit, returns the index of the free rect or -1
+static int FindPosition(const PackPage* const _page, int _width, int _height, int* const _score)
+{
+	int best = -1;
+	*_score = INT_MAX;
+	for (int i = 0; i < _page->count; i++)
+	{
+		const FreeRect* free = &_page->free[i];
+		if (free->width >= _width && free->height >= _height)
+		{
+			int leftoverX = free->width - _width;
+			int leftoverY = free->height - _height;
+			int score = leftoverX < leftoverY ? leftoverX : leftoverY;
+			if (score < *_score)
+			{
+				*_score = score;
+				best = i;
+			}
+		}
+	}
+	return best;
+}
+
+static bool Place(PackPage* const _page, FreeRect _used)
+{
+	// Every free rect the new one overlaps is split into up to four maximal rects
+	int count = _page->count;
+	for (int i = 0; i < count; i++)
+	{
+		FreeRect free = _page->free[i];
+		if (_used.x >= free.x + free.width || _used.x + _used.width <= free.x
+			|| _used.y >= free.y + free.height || _used.y + _used.height <= free.y)
+		{
+			continue;
+		}
+
+		bool isAdded = true;
+		if (_used.x > free.x)
+		{
+			isAdded = isAdded && AddFree(_page, (FreeRect) { free.x, free.y, _used.x - free.x, free.height });
+		}
+		if (_used.x + _used.width < free.x + free.width)
+		{
+			int x = _used.x + _used.width;
+			isAdded = isAdded && AddFree(_page, (FreeRect) { x, free.y, free.x + free.width - x, free.height });
+		}
+		if (_used.y > free.y)
+		{
+			isAdded = isAdded && AddFree(_page, (FreeRect) { free.x, free.y, free.width, _used.y - free.y });
+		}
+		if (_used.y + _used.height < free.y + free.height)
+		{
+			int y = _used.y + _used.height;
+			isAdded = isAdded && AddFree(_page, (FreeRect) { free.x, y, free.width, free.y + free.height - y });
+		}
+		if (!isAdded)
+		{
+			return false;
+		}
+
+		// Swap with the last of the original rects, the split rects stay after them
+		_page->free[i] = _page->free[count - 1];
+		_page->free[count - 1] = _page->free[_page->count - 1];
+		_page->count--;
+		count--;
+		i--;
+	}
+
+	// Drop the free rects that another one already covers
+	for (int i = 0; i < _page->count; i++)
+	{
+		for (int j = i + 1; j < _page->count; j++)
+		{
+			if (Contains(_page->free[j], _page->free[i]))
+			{
+				_page->free[i--] = _page->free[--_page->count];
+				break;
+			}
+			if (Contains(_page->free[i], _page->free[j]))
+			{
+				_page->free[j--] = _page->free[--_page->count];
+			}
+		}
+	}
+	return true;
+}
+
+static int CompareArea(const void* _a, const void* _b)
+{
+	const PackRect* a = *(const PackRect* const*)_a;
+	const PackRect* b = *(const PackRect* const*)_b;
+	int sideA = a->width > a->height ? a->width : a->height;
+	int sideB = b->width > b->height ? b->width : b->height;
+	if (sideA != sideB)
+	{
+		return sideA > sideB ? -1 : 1;
+	}
+	long long areaA = (long long)a->width * a->height;
+	long long areaB = (long long)b->width * b->height;
+	return (areaA < areaB) - (areaA > areaB);
+}
+
+int Pack(PackRect* const _rects, int _count, int _pageSize, int _padding)
+{
+	PackRect** order = malloc(_count * sizeof(PackRect*));
+	PackPage* pages = calloc(_count ? _count : 1, sizeof(PackPage));
+	if (!order || !pages)
+	{
+		free(order);
+		free(pages);
+		return -1;
+	}
+	for (int i = 0; i < _count; i++)
+	{
+		order[i] = &_rects[i];
+	}
+	qsort(order, _count, sizeof(PackRect*), CompareArea);
+
+	// The padding is on the right and bottom of every rect, the page is one padding bigger to match
+	int pageCount = 0;
+	bool isPacked = true;
+	for (int i = 0; i < _count && isPacked; i++)
+	{
+		PackRect* rect = order[i];
+		int width = rect->width + _padding;
+		int height = rect->height + _padding;
+		int bestPage = -1;
+		int bestIndex = -1;
+		int bestScore = INT_MAX;
+		for (int page = 0; page < pageCount; page++)
+		{
+			int score;
+			int index = FindPosition(&pages[page], width, height, &score);
+			if (index >= 0 && score < bestScore)
+			{
+				bestPage = page;
+				bestIndex = index;
+				bestScore = score;
+			}
+		}
+		if (bestIndex < 0)
+		{
+			bestPage = pageCount++;
+			isPacked = AddFree(&pages[bestPage], (FreeRect) { _padding, _padding, _pageSize - _padding, _pageSize - _padding })
+				&& (bestIndex = FindPosition(&pages[bestPage], width, height, &bestScore)) >= 0;
+			if (!isPacked)
+			{
+				break;
+			}
+		}
+
+		const FreeRect* free = &pages[bestPage].free[bestIndex];
+		rect->x = free->x;
+		rect->y = free->y;
+		rect->page = bestPage;
+		isPacked = Place(&pages[bestPage], (FreeRect) { rect->x, rect->y, width, height });
+	}
+
+	for (int page = 0; page < pageCount; page++)
+	{
+		free(pages[page].free);
+	}
+	free(pages);
+	free(order);
+	return isPacked ? pageCount : -1;
+}
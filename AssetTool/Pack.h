@@ -0,0 +1,24 @@
+#pragma once
+#include <stdbool.h>
+
+// MaxRects bin packer: every page keeps the list of maximal free rectangles,
+// each rect goes where it leaves the shortest leftover side (best short side
+// fit). Rects are placed biggest first, a new page opens when none fits.
+
+#pragma region Struct and Enum
+typedef struct PackRect
+{
+	// Input, without the padding
+	int width;
+	int height;
+	// Output
+	int x;
+	int y;
+	int page;
+}PackRect;
+#pragma endregion
+
+#pragma region Definition
+// Returns the page count, or -1 if a rect can never fit or memory runs out
+int Pack(PackRect* const _rects, int _count, int _pageSize, int _padding);
+#pragma endregion
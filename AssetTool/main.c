@@ -0,0 +1,513 @@
+#ifndef _WIN32
+// opendir and mkdir are POSIX, strict C modes hide them otherwise
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SFML/Graphics.h>
+#include "Atlas.h"
+#include "AssetPack.h"
+#include "File.h"
+#include "Pack.h"
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#pragma region Define
+#define DEFAULT_PAGE_SIZE 2048
+#define DEFAULT_PADDING 1
+#define MAX_SPRITES 256
+#define MAX_BUNDLE_FILES 256
+#define MANIFEST_NAME "Sprites.txt"
+#pragma endregion
+
+#pragma region Struct and Enum
+// One line of the manifest, sprites it does not list are one frame pivoted on their top left corner
+typedef struct SpriteInfo
+{
+	char name[ATLAS_NAME_LENGTH];
+	int frameCount;
+	// Fraction of the frame size
+	float pivotX;
+	float pivotY;
+	bool isUsed;
+}SpriteInfo;
+
+typedef struct Manifest
+{
+	SpriteInfo sprites[MAX_SPRITES];
+	int count;
+}Manifest;
+#pragma endregion
+
+#pragma region Definition
+int RunPack(int argc, char** argv);
+int RunBundle(int argc, char** argv);
+int ListFiles(const char* _directory, const char* _extension, char _names[][ATLAS_NAME_LENGTH], int _maxCount);
+void* LoadFile(const char* _path, size_t* const _size);
+bool ReadManifest(Manifest* const _manifest, const char* _path);
+SpriteInfo* FindInfo(Manifest* const _manifest, const char* _name);
+sfIntRect TrimFrame(const sfImage* _image, sfIntRect _frame);
+bool MakeDirectory(const char* _path);
+int CompareName(const void* _a, const void* _b);
+#pragma endregion
+
+#pragma region Core
+int main(int argc, char** argv)
+{
+	if (argc > 3 && strcmp(argv[1], "pack") == 0)
+	{
+		return RunPack(argc, argv);
+	}
+	if (argc > 4 && strcmp(argv[1], "bundle") == 0)
+	{
+		return RunBundle(argc, argv);
+	}
+
+	printf("usage: AssetTool pack <sprite directory> <atlas file> [--page-size 2048] [--padding 1] [--no-trim]\n");
+	printf("Packs every PNG of the directory, %s in it gives the frame count and pivot of each sheet\n", MANIFEST_NAME);
+	printf("usage: AssetTool bundle <asset directory> <pack file> <subdirectory>...\n");
+	printf("Writes every file of the subdirectories in one pack, named <subdirectory>/<file>\n");
+	return EXIT_FAILURE;
+}
+
+int RunPack(int argc, char** argv)
+{
+	const char* directory = argv[2];
+	const char* atlasPath = argv[3];
+	int pageSize = DEFAULT_PAGE_SIZE;
+	int padding = DEFAULT_PADDING;
+	bool isTrimmed = true;
+	for (int i = 4; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--page-size") == 0 && i + 1 < argc)
+		{
+			pageSize = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc)
+		{
+			padding = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--no-trim") == 0)
+		{
+			isTrimmed = false;
+		}
+	}
+
+	static char names[MAX_SPRITES][ATLAS_NAME_LENGTH];
+	int spriteCount = ListFiles(directory, ".png", names, MAX_SPRITES);
+	if (spriteCount <= 0)
+	{
+		printf("No PNG in %s\n", directory);
+		return EXIT_FAILURE;
+	}
+	qsort(names, spriteCount, ATLAS_NAME_LENGTH, CompareName);
+
+	static Manifest manifest;
+	char path[ATLAS_PATH_LENGTH];
+	snprintf(path, sizeof(path), "%s/%s", directory, MANIFEST_NAME);
+	if (!ReadManifest(&manifest, path))
+	{
+		printf("No manifest at %s, every image is one frame\n", path);
+	}
+
+	// Cut every sheet into frames and trim them
+	Atlas atlas = { 0 };
+	sfImage* images[MAX_SPRITES] = { 0 };
+	atlas.sprites = calloc(spriteCount, sizeof(AtlasSprite));
+	int frameCapacity = spriteCount;
+	atlas.frames = malloc(frameCapacity * sizeof(AtlasFrame));
+	PackRect* rects = malloc(frameCapacity * sizeof(PackRect));
+	long long sourcePixels = 0;
+	long long packedPixels = 0;
+	bool isValid = atlas.sprites && atlas.frames && rects;
+	for (int i = 0; i < spriteCount && isValid; i++)
+	{
+		snprintf(path, sizeof(path), "%s/%s.png", directory, names[i]);
+		images[i] = sfImage_createFromFile(path);
+		if (!images[i])
+		{
+			printf("Could not read %s\n", path);
+			isValid = false;
+			break;
+		}
+
+		SpriteInfo* info = FindInfo(&manifest, names[i]);
+		sfVector2u imageSize = sfImage_getSize(images[i]);
+		AtlasSprite* sprite = &atlas.sprites[atlas.spriteCount++];
+		snprintf(sprite->name, ATLAS_NAME_LENGTH, "%s", names[i]);
+		sprite->frameCount = info ? info->frameCount : 1;
+		// Sheets are one row of frames, like the animations used to cut them
+		sprite->size = (sfVector2i){ (int)imageSize.x / sprite->frameCount, (int)imageSize.y };
+		sprite->pivot = info ? (sfVector2f) { sprite->size.x * info->pivotX, sprite->size.y * info->pivotY } : (sfVector2f) { 0, 0 };
+		sprite->firstFrame = atlas.frameCount;
+
+		if (atlas.frameCount + sprite->frameCount > frameCapacity)
+		{
+			frameCapacity = (atlas.frameCount + sprite->frameCount) * 2;
+			AtlasFrame* frames = realloc(atlas.frames, frameCapacity * sizeof(AtlasFrame));
+			atlas.frames = frames ? frames : atlas.frames;
+			PackRect* grown = realloc(rects, frameCapacity * sizeof(PackRect));
+			rects = grown ? grown : rects;
+			isValid = frames && grown;
+		}
+		for (int j = 0; j < sprite->frameCount && isValid; j++)
+		{
+			sfIntRect source = { j * sprite->size.x, 0, sprite->size.x, sprite->size.y };
+			sfIntRect trimmed = isTrimmed ? TrimFrame(images[i], source) : source;
+			AtlasFrame* frame = &atlas.frames[atlas.frameCount];
+			// The rect still points in the sheet until the pages are built
+			frame->rect = trimmed;
+			frame->offset = (sfVector2i){ trimmed.left - source.left, trimmed.top - source.top };
+			rects[atlas.frameCount] = (PackRect){ trimmed.width, trimmed.height, 0, 0, 0 };
+			sourcePixels += (long long)source.width * source.height;
+			packedPixels += (long long)trimmed.width * trimmed.height;
+			atlas.frameCount++;
+		}
+	}
+	for (int i = 0; i < manifest.count; i++)
+	{
+		if (!manifest.sprites[i].isUsed)
+		{
+			printf("Warning: %s is in the manifest but has no image\n", manifest.sprites[i].name);
+		}
+	}
+
+	int pageCount = isValid ? Pack(rects, atlas.frameCount, pageSize, padding) : -1;
+	if (pageCount < 0 || pageCount > ATLAS_MAX_PAGES)
+	{
+		printf(isValid ? "Could not pack the frames in %d pages of %d pixels\n" : "Could not load the sprites\n", ATLAS_MAX_PAGES, pageSize);
+		isValid = false;
+	}
+
+	// Pages are cropped to what they use, next to the metadata
+	const char* slash = strrchr(atlasPath, '/');
+	const char* backslash = strrchr(atlasPath, '\\');
+	slash = backslash > slash ? backslash : slash;
+	int directoryLength = slash ? (int)(slash - atlasPath + 1) : 0;
+	const char* baseName = atlasPath + directoryLength;
+	int baseLength = (int)(strcspn(baseName, "."));
+	if (isValid && directoryLength)
+	{
+		snprintf(path, sizeof(path), "%.*s", directoryLength - 1, atlasPath);
+		MakeDirectory(path);
+	}
+
+	atlas.pageCount = isValid ? pageCount : 0;
+	for (int page = 0; page < atlas.pageCount && isValid; page++)
+	{
+		int width = 1;
+		int height = 1;
+		for (int i = 0; i < atlas.frameCount; i++)
+		{
+			if (rects[i].page == page)
+			{
+				width = rects[i].x + rects[i].width + padding > width ? rects[i].x + rects[i].width + padding : width;
+				height = rects[i].y + rects[i].height + padding > height ? rects[i].y + rects[i].height + padding : height;
+			}
+		}
+
+		sfImage* image = sfImage_createFromColor(width, height, sfTransparent);
+		for (int i = 0; i < atlas.spriteCount && image; i++)
+		{
+			const AtlasSprite* sprite = &atlas.sprites[i];
+			for (int j = 0; j < sprite->frameCount; j++)
+			{
+				int index = sprite->firstFrame + j;
+				if (rects[index].page != page)
+				{
+					continue;
+				}
+				AtlasFrame* frame = &atlas.frames[index];
+				sfImage_copyImage(image, images[i], rects[index].x, rects[index].y, frame->rect, sfFalse);
+				frame->page = page;
+				frame->rect.left = rects[index].x;
+				frame->rect.top = rects[index].y;
+			}
+		}
+
+		snprintf(atlas.pages[page], ATLAS_NAME_LENGTH, "%.*s%d.png", baseLength, baseName, page);
+		snprintf(path, sizeof(path), "%.*s%s", directoryLength, atlasPath, atlas.pages[page]);
+		isValid = image && sfImage_saveToFile(image, path);
+		if (image)
+		{
+			sfImage_destroy(image);
+		}
+		if (!isValid)
+		{
+			printf("Could not write %s\n", path);
+			break;
+		}
+		printf("page %d: %s, %dx%d\n", page, path, width, height);
+	}
+
+	if (isValid && !AtlasWrite(&atlas, atlasPath))
+	{
+		printf("Could not write %s\n", atlasPath);
+		isValid = false;
+	}
+	if (isValid)
+	{
+		printf("sprites: %d\n", atlas.spriteCount);
+		printf("frames: %d\n", atlas.frameCount);
+		printf("pixels: %lld, %lld after trimming (%.1f%%)\n", sourcePixels, packedPixels,
+			sourcePixels ? packedPixels * 100.0 / sourcePixels : 0.0);
+	}
+
+	for (int i = 0; i < spriteCount; i++)
+	{
+		if (images[i])
+		{
+			sfImage_destroy(images[i]);
+		}
+	}
+	free(rects);
+	free(atlas.sprites);
+	free(atlas.frames);
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int RunBundle(int argc, char** argv)
+{
+	const char* directory = argv[2];
+	const char* packPath = argv[3];
+	static AssetSource sources[MAX_BUNDLE_FILES];
+	static char entryNames[MAX_BUNDLE_FILES][ASSET_PACK_NAME_LENGTH];
+	int count = 0;
+	size_t totalSize = 0;
+	bool isValid = true;
+	for (int i = 4; i < argc && isValid; i++)
+	{
+		static char names[MAX_BUNDLE_FILES][ATLAS_NAME_LENGTH];
+		char path[ATLAS_PATH_LENGTH];
+		snprintf(path, sizeof(path), "%s/%s", directory, argv[i]);
+		int fileCount = ListFiles(path, "", names, MAX_BUNDLE_FILES - count);
+		if (fileCount <= 0)
+		{
+			printf("Nothing to bundle in %s\n", path);
+			isValid = false;
+			break;
+		}
+
+		for (int j = 0; j < fileCount && isValid; j++)
+		{
+			snprintf(path, sizeof(path), "%s/%s/%s", directory, argv[i], names[j]);
+			AssetSource* source = &sources[count];
+			source->data = LoadFile(path, &source->size);
+			if (!source->data)
+			{
+				printf("Could not read %s\n", path);
+				isValid = false;
+				break;
+			}
+			snprintf(entryNames[count], ASSET_PACK_NAME_LENGTH, "%s/%s", argv[i], names[j]);
+			source->name = entryNames[count];
+			totalSize += source->size;
+			count++;
+		}
+	}
+
+	if (isValid && !AssetPackWrite(sources, count, packPath))
+	{
+		printf("Could not write %s\n", packPath);
+		isValid = false;
+	}
+	if (isValid)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			printf("%-32s %8zu bytes  crc %08x\n", sources[i].name, sources[i].size, AssetPackChecksum(sources[i].data, sources[i].size));
+		}
+		printf("files: %d, %zu bytes\n", count, totalSize);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		free((void*)sources[i].data);
+	}
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#pragma endregion
+
+int ListFiles(const char* _directory, const char* _extension, char _names[][ATLAS_NAME_LENGTH], int _maxCount)
+{
+	int count = 0;
+#ifdef _WIN32
+	char pattern[ATLAS_PATH_LENGTH];
+	snprintf(pattern, sizeof(pattern), "%s\\*%s", _directory, _extension);
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA(pattern, &data);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return 0;
+	}
+	do
+	{
+		const char* name = data.cFileName;
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			continue;
+		}
+#else
+	DIR* directory = opendir(_directory);
+	if (!directory)
+	{
+		return 0;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != NULL)
+	{
+		const char* name = entry->d_name;
+		char path[ATLAS_PATH_LENGTH];
+		struct stat status;
+		snprintf(path, sizeof(path), "%s/%s", _directory, name);
+		if (stat(path, &status) != 0 || S_ISDIR(status.st_mode))
+		{
+			continue;
+		}
+#endif
+		// The extension is cut from the names, an empty one keeps every file whole
+		size_t length = strlen(name);
+		size_t extensionLength = strlen(_extension);
+		if (length > extensionLength && strcmp(name + length - extensionLength, _extension) == 0)
+		{
+			if (length - extensionLength >= ATLAS_NAME_LENGTH || count == _maxCount)
+			{
+				printf("Skipped %s\n", name);
+			}
+			else
+			{
+				snprintf(_names[count++], ATLAS_NAME_LENGTH, "%.*s", (int)(length - extensionLength), name);
+			}
+		}
+#ifdef _WIN32
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	}
+	closedir(directory);
+#endif
+	return count;
+}
+
+void* LoadFile(const char* _path, size_t* const _size)
+{
+	FILE* file = FileOpen(_path, "rb");
+	if (!file)
+	{
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	// One more byte so an empty file still gets a pointer
+	void* data = size >= 0 ? malloc((size_t)size + 1) : NULL;
+	if (data && fread(data, 1, (size_t)size, file) != (size_t)size)
+	{
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	*_size = data ? (size_t)size : 0;
+	return data;
+}
+
+bool ReadManifest(Manifest* const _manifest, const char* _path)
+{
+	_manifest->count = 0;
+	FILE* file = FileOpen(_path, "r");
+	if (!file)
+	{
+		return false;
+	}
+
+	// One sheet per line: name, frame count, pivot x and y as fractions of a frame
+	char line[256];
+	int lineNumber = 0;
+	while (fgets(line, sizeof(line), file))
+	{
+		lineNumber++;
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+		{
+			continue;
+		}
+		SpriteInfo info = { 0 };
+		char format[32];
+		snprintf(format, sizeof(format), "%%%ds %%d %%f %%f", ATLAS_NAME_LENGTH - 1);
+		if (FileScan(line, format, FILE_SCAN_STRING(info.name), &info.frameCount, &info.pivotX, &info.pivotY) != 4 || info.frameCount < 1)
+		{
+			printf("%s:%d: expected <name> <frames> <pivot x> <pivot y>\n", _path, lineNumber);
+			continue;
+		}
+		if (_manifest->count < MAX_SPRITES)
+		{
+			_manifest->sprites[_manifest->count++] = info;
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+SpriteInfo* FindInfo(Manifest* const _manifest, const char* _name)
+{
+	for (int i = 0; i < _manifest->count; i++)
+	{
+		if (strcmp(_manifest->sprites[i].name, _name) == 0)
+		{
+			_manifest->sprites[i].isUsed = true;
+			return &_manifest->sprites[i];
+		}
+	}
+	return NULL;
+}
+
+sfIntRect TrimFrame(const sfImage* _image, sfIntRect _frame)
+{
+	// Smallest rect holding every pixel that is not fully transparent
+	const sfUint8* pixels = sfImage_getPixelsPtr(_image);
+	unsigned int stride = sfImage_getSize(_image).x * 4;
+	int left = _frame.left + _frame.width;
+	int right = _frame.left - 1;
+	int top = _frame.top + _frame.height;
+	int bottom = _frame.top - 1;
+	for (int y = _frame.top; y < _frame.top + _frame.height; y++)
+	{
+		const sfUint8* row = pixels + y * stride;
+		for (int x = _frame.left; x < _frame.left + _frame.width; x++)
+		{
+			if (row[x * 4 + 3])
+			{
+				left = x < left ? x : left;
+				right = x > right ? x : right;
+				top = y < top ? y : top;
+				bottom = y > bottom ? y : bottom;
+			}
+		}
+	}
+
+	// An empty frame keeps a single transparent pixel
+	if (right < left)
+	{
+		return (sfIntRect) { _frame.left, _frame.top, 1, 1 };
+	}
+	return (sfIntRect) { left, top, right - left + 1, bottom - top + 1 };
+}
+
+bool MakeDirectory(const char* _path)
+{
+#ifdef _WIN32
+	return _mkdir(_path) == 0;
+#else
+	return mkdir(_path, 0755) == 0;
+#endif
+}
+
+int CompareName(const void* _a, const void* _b)
+{
+	return strcmp(_a, _b);
+}
@@ -0,0 +1,313 @@
+#ifndef _WIN32
+// mmap and readlink are POSIX, strict C modes hide them otherwise
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "File.h"
+#include "AssetPack.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#pragma region Definition
+static const uint8_t* MapFile(const char* _path, size_t* const _size);
+static void UnmapFile(const uint8_t* _data, size_t _size);
+static uint32_t ReadU32(const uint8_t* _data);
+static void WriteU32(FILE* _file, uint32_t _value);
+static uint64_t AlignUp(uint64_t _value);
+static int CompareEntry(const void* _a, const void* _b);
+static int CompareSource(const void* _a, const void* _b);
+static sfInt64 StreamRead(void* _data, sfInt64 _size, void* _userData);
+static sfInt64 StreamSeek(sfInt64 _position, void* _userData);
+static sfInt64 StreamTell(void* _userData);
+static sfInt64 StreamGetSize(void* _userData);
+#pragma endregion
+
+bool AssetPackOpen(AssetPack* const _pack, const char* _path)
+{
+	*_pack = (AssetPack){ 0 };
+	_pack->data = MapFile(_path, &_pack->size);
+	if (!_pack->data)
+	{
+		return false;
+	}
+
+	const uint8_t* data = _pack->data;
+	uint32_t entryCount = _pack->size >= ASSET_PACK_HEADER_SIZE ? ReadU32(data + 8) : 0;
+	bool isValid = _pack->size >= ASSET_PACK_HEADER_SIZE && memcmp(data, ASSET_PACK_MAGIC, 4) == 0
+		&& ReadU32(data + 4) == ASSET_PACK_VERSION
+		&& entryCount <= (_pack->size - ASSET_PACK_HEADER_SIZE) / ASSET_PACK_RECORD_SIZE;
+	_pack->entries = isValid && entryCount ? malloc(entryCount * sizeof(AssetEntry)) : NULL;
+	isValid = isValid && (_pack->entries || !entryCount);
+
+	// A bad index is caught here, a bad entry only when something asks for it
+	for (uint32_t i = 0; i < entryCount && isValid; i++)
+	{
+		const uint8_t* record = data + ASSET_PACK_HEADER_SIZE + i * ASSET_PACK_RECORD_SIZE;
+		AssetEntry* entry = &_pack->entries[i];
+		memcpy(entry->name, record, ASSET_PACK_NAME_LENGTH);
+		entry->offset = ReadU32(record + ASSET_PACK_NAME_LENGTH);
+		entry->size = ReadU32(record + ASSET_PACK_NAME_LENGTH + 4);
+		entry->checksum = ReadU32(record + ASSET_PACK_NAME_LENGTH + 8);
+		isValid = entry->name[ASSET_PACK_NAME_LENGTH - 1] == '\0' && entry->offset % ASSET_PACK_ALIGNMENT == 0
+			&& entry->offset <= _pack->size && entry->size <= _pack->size - entry->offset
+			&& (i == 0 || strcmp(_pack->entries[i - 1].name, entry->name) < 0);
+	}
+	_pack->entryCount = isValid ? (int)entryCount : 0;
+
+	if (!isValid)
+	{
+		AssetPackClose(_pack);
+	}
+	return isValid;
+}
+
+void AssetPackClose(AssetPack* const _pack)
+{
+	if (_pack->data)
+	{
+		UnmapFile(_pack->data, _pack->size);
+	}
+	free(_pack->entries);
+	*_pack = (AssetPack){ 0 };
+}
+
+const AssetEntry* AssetPackFind(const AssetPack* const _pack, const char* _name)
+{
+	if (!_pack->entryCount)
+	{
+		return NULL;
+	}
+	return bsearch(_name, _pack->entries, _pack->entryCount, sizeof(AssetEntry), CompareEntry);
+}
+
+const void* AssetPackGet(const AssetPack* const _pack, const char* _name, size_t* const _size)
+{
+	const AssetEntry* entry = AssetPackFind(_pack, _name);
+	if (!entry)
+	{
+		return NULL;
+	}
+	const uint8_t* data = _pack->data + entry->offset;
+	if (AssetPackChecksum(data, entry->size) != entry->checksum)
+	{
+		return NULL;
+	}
+	*_size = entry->size;
+	return data;
+}
+
+bool AssetPackWrite(AssetSource* const _sources, int _count, const char* _path)
+{
+	qsort(_sources, _count, sizeof(AssetSource), CompareSource);
+	uint64_t dataStart = AlignUp(ASSET_PACK_HEADER_SIZE + (uint64_t)_count * ASSET_PACK_RECORD_SIZE);
+	uint64_t end = dataStart;
+	for (int i = 0; i < _count; i++)
+	{
+		// Offsets are 32 bit, so is the whole pack: checked in 64 bit before anything is written
+		end = AlignUp(end) + _sources[i].size;
+		if (strlen(_sources[i].name) >= ASSET_PACK_NAME_LENGTH || _sources[i].size > UINT32_MAX || end > UINT32_MAX
+			|| (i > 0 && strcmp(_sources[i - 1].name, _sources[i].name) == 0))
+		{
+			return false;
+		}
+	}
+
+	FILE* file = FileOpen(_path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fwrite(ASSET_PACK_MAGIC, 1, 4, file);
+	WriteU32(file, ASSET_PACK_VERSION);
+	WriteU32(file, (uint32_t)_count);
+	WriteU32(file, 0);
+
+	uint64_t offset = dataStart;
+	for (int i = 0; i < _count; i++)
+	{
+		char name[ASSET_PACK_NAME_LENGTH] = { 0 };
+		memcpy(name, _sources[i].name, strlen(_sources[i].name));
+		fwrite(name, 1, ASSET_PACK_NAME_LENGTH, file);
+		WriteU32(file, (uint32_t)offset);
+		WriteU32(file, (uint32_t)_sources[i].size);
+		WriteU32(file, AssetPackChecksum(_sources[i].data, _sources[i].size));
+		WriteU32(file, 0);
+		offset = AlignUp(offset + _sources[i].size);
+	}
+
+	static const uint8_t padding[ASSET_PACK_ALIGNMENT] = { 0 };
+	uint64_t position = ASSET_PACK_HEADER_SIZE + (uint64_t)_count * ASSET_PACK_RECORD_SIZE;
+	for (int i = 0; i < _count; i++)
+	{
+		fwrite(padding, 1, (size_t)(AlignUp(position) - position), file);
+		fwrite(_sources[i].data, 1, _sources[i].size, file);
+		position = AlignUp(position) + _sources[i].size;
+	}
+
+	bool isWritten = !ferror(file);
+	fclose(file);
+	return isWritten;
+}
+
+uint32_t AssetPackChecksum(const void* _data, size_t _size)
+{
+	// CRC-32 (the zlib one), four bits at a time to keep the table small
+	static const uint32_t table[16] =
+	{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+	};
+	const uint8_t* data = _data;
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < _size; i++)
+	{
+		crc ^= data[i];
+		crc = (crc >> 4) ^ table[crc & 0xF];
+		crc = (crc >> 4) ^ table[crc & 0xF];
+	}
+	return ~crc;
+}
+
+void AssetPackPath(char* const _path, size_t _size, const char* _name)
+{
+	char executable[ASSET_PACK_PATH_LENGTH];
+	int length = 0;
+#ifdef _WIN32
+	DWORD written = GetModuleFileNameA(NULL, executable, sizeof(executable));
+	length = written < sizeof(executable) ? (int)written : 0;
+#else
+	ssize_t written = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+	length = written > 0 ? (int)written : 0;
+#endif
+	executable[length] = '\0';
+
+	// Without the executable path the working directory is the best guess left
+	const char* slash = strrchr(executable, '/');
+	const char* backslash = strrchr(executable, '\\');
+	slash = backslash > slash ? backslash : slash;
+	int directoryLength = slash ? (int)(slash - executable + 1) : 0;
+	snprintf(_path, _size, "%.*s%s", directoryLength, executable, _name);
+}
+
+void AssetStreamOpen(AssetStream* const _stream, const void* _data, size_t _size)
+{
+	_stream->data = _data;
+	_stream->size = (sfInt64)_size;
+	_stream->position = 0;
+	_stream->stream = (sfInputStream){ StreamRead, StreamSeek, StreamTell, StreamGetSize, _stream };
+}
+
+static const uint8_t* MapFile(const char* _path, size_t* const _size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+	LARGE_INTEGER size;
+	HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	// The view keeps the file and the mapping alive on its own
+	const uint8_t* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+	*_size = data ? (size_t)size.QuadPart : 0;
+	return data;
+#else
+	int file = open(_path, O_RDONLY);
+	if (file < 0)
+	{
+		return NULL;
+	}
+	struct stat status;
+	void* data = fstat(file, &status) == 0 && status.st_size > 0
+		? mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	close(file);
+	*_size = data != MAP_FAILED ? (size_t)status.st_size : 0;
+	return data != MAP_FAILED ? data : NULL;
+#endif
+}
+
+static void UnmapFile(const uint8_t* _data, size_t _size)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(_data);
+#else
+	munmap((void*)_data, _size);
+#endif
+}
+
+static uint32_t ReadU32(const uint8_t* _data)
+{
+	return (uint32_t)_data[0] | (uint32_t)_data[1] << 8 | (uint32_t)_data[2] << 16 | (uint32_t)_data[3] << 24;
+}
+
+static void WriteU32(FILE* _file, uint32_t _value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		fputc((int)((_value >> (i * 8)) & 0xFF), _file);
+	}
+}
+
+static uint64_t AlignUp(uint64_t _value)
+{
+	return (_value + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+static int CompareEntry(const void* _a, const void* _b)
+{
+	return strcmp(_a, ((const AssetEntry*)_b)->name);
+}
+
+static int CompareSource(const void* _a, const void* _b)
+{
+	return strcmp(((const AssetSource*)_a)->name, ((const AssetSource*)_b)->name);
+}
+
+static sfInt64 StreamRead(void* _data, sfInt64 _size, void* _userData)
+{
+	AssetStream* stream = _userData;
+	sfInt64 count = stream->size - stream->position;
+	count = _size < count ? _size : count;
+	if (count <= 0)
+	{
+		return 0;
+	}
+	memcpy(_data, stream->data + stream->position, (size_t)count);
+	stream->position += count;
+	return count;
+}
+
+static sfInt64 StreamSeek(sfInt64 _position, void* _userData)
+{
+	AssetStream* stream = _userData;
+	if (_position < 0 || _position > stream->size)
+	{
+		return -1;
+	}
+	stream->position = _position;
+	return _position;
+}
+
+static sfInt64 StreamTell(void* _userData)
+{
+	return ((AssetStream*)_userData)->position;
+}
+
+static sfInt64 StreamGetSize(void* _userData)
+{
+	return ((AssetStream*)_userData)->size;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SFML/System/InputStream.h>
+
+// Asset pack written by AssetTool: every file the game loads in one file that
+// is mapped in memory once. Entries go to the createFromMemory and
+// createFromStream entry points straight out of the mapping, nothing is read
+// or copied before a decoder touches it.
+//
+// On disk, integers are 32 bit little-endian:
+// magic, version, entry count, reserved, then the index with one fixed size
+// record per entry sorted by name (name padded with zeros, offset, size,
+// CRC-32, reserved), then the data of every entry on an alignment boundary.
+
+#pragma region Define
+#define ASSET_PACK_MAGIC "TMPK"
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_NAME_LENGTH 48
+#define ASSET_PACK_HEADER_SIZE 16
+#define ASSET_PACK_RECORD_SIZE (ASSET_PACK_NAME_LENGTH + 16)
+// Every entry starts on a cache line
+#define ASSET_PACK_ALIGNMENT 64
+#define ASSET_PACK_PATH_LENGTH 512
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct AssetEntry
+{
+	// Path relative to the packed directory, with forward slashes
+	char name[ASSET_PACK_NAME_LENGTH];
+	uint32_t offset;
+	uint32_t size;
+	uint32_t checksum;
+}AssetEntry;
+
+typedef struct AssetPack
+{
+	const uint8_t* data;
+	size_t size;
+	// Parsed from the index, sorted by name
+	AssetEntry* entries;
+	int entryCount;
+}AssetPack;
+
+// One file to write, the data only has to live until AssetPackWrite returns
+typedef struct AssetSource
+{
+	const char* name;
+	const void* data;
+	size_t size;
+}AssetSource;
+
+// Read only stream over a block of memory, for what wants to stream rather than decode at once.
+// The stream field must stay first, CSFML gets a pointer to it.
+typedef struct AssetStream
+{
+	sfInputStream stream;
+	const uint8_t* data;
+	sfInt64 size;
+	sfInt64 position;
+}AssetStream;
+#pragma endregion
+
+#pragma region Definition
+// Maps the whole file read only and checks the index, entries are only checked when fetched
+bool AssetPackOpen(AssetPack* const _pack, const char* _path);
+void AssetPackClose(AssetPack* const _pack);
+const AssetEntry* AssetPackFind(const AssetPack* const _pack, const char* _name);
+// Data of an entry inside the mapping, NULL if it is missing or its checksum does not match
+const void* AssetPackGet(const AssetPack* const _pack, const char* _name, size_t* const _size);
+// Sorts the sources by name
+bool AssetPackWrite(AssetSource* const _sources, int _count, const char* _path);
+
+uint32_t AssetPackChecksum(const void* _data, size_t _size);
+// _name in the directory of the running executable, so the pack is found whatever the working directory
+void AssetPackPath(char* const _path, size_t _size, const char* _name);
+
+// The stream is valid as long as the data is, use &_stream->stream as the sfInputStream
+void AssetStreamOpen(AssetStream* const _stream, const void* _data, size_t _size);
+#pragma endregion
@@ -0,0 +1,267 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "File.h"
+#include "Atlas.h"
+
+#pragma region Struct and Enum
+typedef struct Reader
+{
+	const uint8_t* data;
+	size_t size;
+	size_t position;
+}Reader;
+#pragma endregion
+
+#pragma region Definition
+static void WriteVarint(FILE* _file, uint64_t _value);
+static bool ReadVarint(Reader* const _reader, uint64_t* const _value);
+static void WriteFloat(FILE* _file, float _value);
+static bool ReadFloat(Reader* const _reader, float* const _value);
+static void WriteString(FILE* _file, const char* _text);
+static bool ReadString(Reader* const _reader, char* const _text, size_t _size);
+static bool ReadInt(Reader* const _reader, int* const _value);
+static int ReadByte(Reader* const _reader);
+#pragma endregion
+
+bool AtlasRead(Atlas* const _atlas, const void* _data, size_t _size)
+{
+	*_atlas = (Atlas){ 0 };
+	Reader reader = { _data, _size, 0 };
+
+	int pageCount = 0;
+	bool isValid = _size > 4 && memcmp(_data, ATLAS_MAGIC, 4) == 0;
+	reader.position = 4;
+	isValid = isValid && ReadByte(&reader) == ATLAS_VERSION && ReadInt(&reader, &pageCount) && pageCount <= ATLAS_MAX_PAGES;
+	for (int i = 0; i < pageCount && isValid; i++)
+	{
+		isValid = ReadString(&reader, _atlas->pages[i], ATLAS_NAME_LENGTH);
+	}
+	_atlas->pageCount = isValid ? pageCount : 0;
+
+	int spriteCount = 0;
+	isValid = isValid && ReadInt(&reader, &spriteCount);
+	_atlas->sprites = isValid && spriteCount ? calloc(spriteCount, sizeof(AtlasSprite)) : NULL;
+	isValid = isValid && (_atlas->sprites || !spriteCount);
+	for (int i = 0; i < spriteCount && isValid; i++)
+	{
+		AtlasSprite* sprite = &_atlas->sprites[i];
+		isValid = ReadString(&reader, sprite->name, ATLAS_NAME_LENGTH) && ReadInt(&reader, &sprite->frameCount) && sprite->frameCount > 0
+			&& ReadInt(&reader, &sprite->size.x) && ReadInt(&reader, &sprite->size.y)
+			&& ReadFloat(&reader, &sprite->pivot.x) && ReadFloat(&reader, &sprite->pivot.y);
+		if (!isValid)
+		{
+			break;
+		}
+
+		sprite->firstFrame = _atlas->frameCount;
+		AtlasFrame* frames = realloc(_atlas->frames, (_atlas->frameCount + sprite->frameCount) * sizeof(AtlasFrame));
+		isValid = frames != NULL;
+		_atlas->frames = frames ? frames : _atlas->frames;
+		for (int j = 0; j < sprite->frameCount && isValid; j++)
+		{
+			AtlasFrame* frame = &_atlas->frames[_atlas->frameCount++];
+			isValid = ReadInt(&reader, &frame->page) && frame->page < pageCount
+				&& ReadInt(&reader, &frame->rect.left) && ReadInt(&reader, &frame->rect.top)
+				&& ReadInt(&reader, &frame->rect.width) && ReadInt(&reader, &frame->rect.height)
+				&& ReadInt(&reader, &frame->offset.x) && ReadInt(&reader, &frame->offset.y);
+		}
+		_atlas->spriteCount = i + 1;
+	}
+
+	if (!isValid)
+	{
+		AtlasDestroy(_atlas);
+	}
+	return isValid;
+}
+
+bool AtlasWrite(const Atlas* const _atlas, const char* _path)
+{
+	FILE* file = FileOpen(_path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fwrite(ATLAS_MAGIC, 1, 4, file);
+	fputc(ATLAS_VERSION, file);
+	WriteVarint(file, _atlas->pageCount);
+	for (int i = 0; i < _atlas->pageCount; i++)
+	{
+		WriteString(file, _atlas->pages[i]);
+	}
+	WriteVarint(file, _atlas->spriteCount);
+	for (int i = 0; i < _atlas->spriteCount; i++)
+	{
+		const AtlasSprite* sprite = &_atlas->sprites[i];
+		WriteString(file, sprite->name);
+		WriteVarint(file, sprite->frameCount);
+		WriteVarint(file, sprite->size.x);
+		WriteVarint(file, sprite->size.y);
+		WriteFloat(file, sprite->pivot.x);
+		WriteFloat(file, sprite->pivot.y);
+		for (int j = 0; j < sprite->frameCount; j++)
+		{
+			const AtlasFrame* frame = &_atlas->frames[sprite->firstFrame + j];
+			WriteVarint(file, frame->page);
+			WriteVarint(file, frame->rect.left);
+			WriteVarint(file, frame->rect.top);
+			WriteVarint(file, frame->rect.width);
+			WriteVarint(file, frame->rect.height);
+			WriteVarint(file, frame->offset.x);
+			WriteVarint(file, frame->offset.y);
+		}
+	}
+
+	bool isWritten = !ferror(file);
+	fclose(file);
+	return isWritten;
+}
+
+void AtlasPagePath(const Atlas* const _atlas, const char* _path, int _page, char* const _pagePath, size_t _size)
+{
+	// Page names are relative to the directory of the metadata
+	const char* slash = strrchr(_path, '/');
+	const char* backslash = strrchr(_path, '\\');
+	slash = backslash > slash ? backslash : slash;
+	int directoryLength = slash ? (int)(slash - _path + 1) : 0;
+	snprintf(_pagePath, _size, "%.*s%s", directoryLength, _path, _atlas->pages[_page]);
+}
+
+void AtlasDestroy(Atlas* const _atlas)
+{
+	free(_atlas->sprites);
+	free(_atlas->frames);
+	*_atlas = (Atlas){ 0 };
+}
+
+const AtlasSprite* AtlasFind(const Atlas* const _atlas, const char* _name)
+{
+	for (int i = 0; i < _atlas->spriteCount; i++)
+	{
+		if (strcmp(_atlas->sprites[i].name, _name) == 0)
+		{
+			return &_atlas->sprites[i];
+		}
+	}
+	return NULL;
+}
+
+const AtlasFrame* AtlasGetFrame(const Atlas* const _atlas, const AtlasSprite* const _sprite, int _frame)
+{
+	if (_frame < 0 || _frame >= _sprite->frameCount)
+	{
+		_frame = 0;
+	}
+	return &_atlas->frames[_sprite->firstFrame + _frame];
+}
+
+void AtlasSetSprite(sfSprite* _sprite, const Atlas* const _atlas, const AtlasSprite* const _atlasSprite, int _frame)
+{
+	const AtlasFrame* frame = AtlasGetFrame(_atlas, _atlasSprite, _frame);
+	const sfTexture* texture = _atlas->textures[frame->page];
+	if (sfSprite_getTexture(_sprite) != texture)
+	{
+		sfSprite_setTexture(_sprite, texture, sfFalse);
+	}
+	sfSprite_setTextureRect(_sprite, frame->rect);
+	// The pivot is in the untrimmed frame, the sprite only has the trimmed pixels
+	sfSprite_setOrigin(_sprite, (sfVector2f) { _atlasSprite->pivot.x - frame->offset.x, _atlasSprite->pivot.y - frame->offset.y });
+}
+
+static void WriteVarint(FILE* _file, uint64_t _value)
+{
+	while (_value >= 0x80)
+	{
+		fputc((int)(_value & 0x7F) | 0x80, _file);
+		_value >>= 7;
+	}
+	fputc((int)_value, _file);
+}
+
+static bool ReadVarint(Reader* const _reader, uint64_t* const _value)
+{
+	*_value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		int byte = ReadByte(_reader);
+		if (byte == EOF)
+		{
+			return false;
+		}
+		*_value |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static void WriteFloat(FILE* _file, float _value)
+{
+	uint32_t bits;
+	memcpy(&bits, &_value, sizeof(bits));
+	for (int i = 0; i < 4; i++)
+	{
+		fputc((int)((bits >> (i * 8)) & 0xFF), _file);
+	}
+}
+
+static bool ReadFloat(Reader* const _reader, float* const _value)
+{
+	uint32_t bits = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		int byte = ReadByte(_reader);
+		if (byte == EOF)
+		{
+			return false;
+		}
+		bits |= (uint32_t)byte << (i * 8);
+	}
+	memcpy(_value, &bits, sizeof(bits));
+	return true;
+}
+
+static void WriteString(FILE* _file, const char* _text)
+{
+	size_t length = strlen(_text);
+	WriteVarint(_file, length);
+	fwrite(_text, 1, length, _file);
+}
+
+static bool ReadString(Reader* const _reader, char* const _text, size_t _size)
+{
+	uint64_t length = 0;
+	if (!ReadVarint(_reader, &length) || length >= _size || length > _reader->size - _reader->position)
+	{
+		return false;
+	}
+	memcpy(_text, _reader->data + _reader->position, (size_t)length);
+	_reader->position += (size_t)length;
+	_text[length] = '\0';
+	return true;
+}
+
+static bool ReadInt(Reader* const _reader, int* const _value)
+{
+	uint64_t value = 0;
+	if (!ReadVarint(_reader, &value) || value > INT32_MAX)
+	{
+		return false;
+	}
+	*_value = (int)value;
+	return true;
+}
+
+static int ReadByte(Reader* const _reader)
+{
+	if (_reader->position >= _reader->size)
+	{
+		return EOF;
+	}
+	return _reader->data[_reader->position++];
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <SFML/Graphics.h>
+
+// Sprite atlas written by AssetTool: every sprite sheet is cut into frames,
+// the transparent border of each frame is trimmed, and the frames are packed
+// into a few pages. The metadata keeps the untrimmed frame size and the pivot
+// so sprites are placed exactly as the loose images were.
+//
+// Metadata on disk, integers are varints:
+// magic, version, page count, page file names (length then bytes),
+// sprite count, then per sprite its name, frame count, frame size,
+// pivot (two little-endian floats) and per frame page, rect and offset.
+
+#pragma region Define
+#define ATLAS_MAGIC "TMAT"
+#define ATLAS_VERSION 1
+#define ATLAS_MAX_PAGES 8
+#define ATLAS_NAME_LENGTH 32
+#define ATLAS_PATH_LENGTH 256
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct AtlasFrame
+{
+	int page;
+	// Trimmed pixels in the page
+	sfIntRect rect;
+	// Where the trimmed pixels start in the untrimmed frame
+	sfVector2i offset;
+}AtlasFrame;
+
+typedef struct AtlasSprite
+{
+	char name[ATLAS_NAME_LENGTH];
+	// Untrimmed size of one frame
+	sfVector2i size;
+	// In pixels of the untrimmed frame, becomes the sprite origin
+	sfVector2f pivot;
+	int frameCount;
+	int firstFrame;
+}AtlasSprite;
+
+typedef struct Atlas
+{
+	// File names relative to the metadata file
+	char pages[ATLAS_MAX_PAGES][ATLAS_NAME_LENGTH];
+	int pageCount;
+	// Set by the owner, who also destroys them
+	sfTexture* textures[ATLAS_MAX_PAGES];
+	AtlasSprite* sprites;
+	int spriteCount;
+	AtlasFrame* frames;
+	int frameCount;
+}Atlas;
+#pragma endregion
+
+#pragma region Definition
+// Metadata only, the owner creates the page textures
+bool AtlasRead(Atlas* const _atlas, const void* _data, size_t _size);
+bool AtlasWrite(const Atlas* const _atlas, const char* _path);
+// Path of a page next to the metadata at _path
+void AtlasPagePath(const Atlas* const _atlas, const char* _path, int _page, char* const _pagePath, size_t _size);
+// Leaves the page textures to the owner
+void AtlasDestroy(Atlas* const _atlas);
+
+const AtlasSprite* AtlasFind(const Atlas* const _atlas, const char* _name);
+const AtlasFrame* AtlasGetFrame(const Atlas* const _atlas, const AtlasSprite* const _sprite, int _frame);
+// Texture, texture rect and origin of one frame, the position and scale are left alone
+void AtlasSetSprite(sfSprite* _sprite, const Atlas* const _atlas, const AtlasSprite* const _atlasSprite, int _frame);
+#pragma endregion
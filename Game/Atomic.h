@@ -0,0 +1,139 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Sequentially consistent atomics on aligned 32/64-bit integers and pointers. MSVC has no
+// <stdatomic.h> in C mode: the Interlocked intrinsics are full barriers, and
+// plain volatile loads are acquire loads on x86/x64. Other compilers use the
+// __atomic builtins.
+
+#pragma region Definition
+static inline int32_t AtomicLoad32(volatile int32_t* _value)
+{
+#ifdef _MSC_VER
+	int32_t value = *_value;
+	_ReadWriteBarrier();
+	return value;
+#else
+	return __atomic_load_n(_value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void AtomicStore32(volatile int32_t* _value, int32_t _new)
+{
+#ifdef _MSC_VER
+	_InterlockedExchange((volatile long*)_value, _new);
+#else
+	__atomic_store_n(_value, _new, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns the new value
+static inline int32_t AtomicAdd32(volatile int32_t* _value, int32_t _add)
+{
+#ifdef _MSC_VER
+	return _InterlockedExchangeAdd((volatile long*)_value, _add) + _add;
+#else
+	return __atomic_add_fetch(_value, _add, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns the previous value
+static inline int32_t AtomicExchange32(volatile int32_t* _value, int32_t _new)
+{
+#ifdef _MSC_VER
+	return _InterlockedExchange((volatile long*)_value, _new);
+#else
+	return __atomic_exchange_n(_value, _new, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool AtomicCompareExchange32(volatile int32_t* _value, int32_t _expected, int32_t _new)
+{
+#ifdef _MSC_VER
+	return _InterlockedCompareExchange((volatile long*)_value, _new, _expected) == _expected;
+#else
+	return __atomic_compare_exchange_n(_value, &_expected, _new, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline int64_t AtomicLoad64(volatile int64_t* _value)
+{
+#if defined(_MSC_VER) && defined(_M_IX86)
+	// 32-bit x86 can not load 64 bits in one plain move
+	return _InterlockedCompareExchange64(_value, 0, 0);
+#elif defined(_MSC_VER)
+	int64_t value = *_value;
+	_ReadWriteBarrier();
+	return value;
+#else
+	return __atomic_load_n(_value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void AtomicStore64(volatile int64_t* _value, int64_t _new)
+{
+#if defined(_MSC_VER) && defined(_M_IX86)
+	int64_t old = *_value;
+	while (_InterlockedCompareExchange64(_value, _new, old) != old)
+	{
+		old = *_value;
+	}
+#elif defined(_MSC_VER)
+	_InterlockedExchange64(_value, _new);
+#else
+	__atomic_store_n(_value, _new, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool AtomicCompareExchange64(volatile int64_t* _value, int64_t _expected, int64_t _new)
+{
+#ifdef _MSC_VER
+	return _InterlockedCompareExchange64(_value, _new, _expected) == _expected;
+#else
+	return __atomic_compare_exchange_n(_value, &_expected, _new, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void* AtomicLoadPointer(void* volatile* _value)
+{
+#ifdef _MSC_VER
+	void* value = *_value;
+	_ReadWriteBarrier();
+	return value;
+#else
+	return __atomic_load_n(_value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void AtomicStorePointer(void* volatile* _value, void* _new)
+{
+#ifdef _MSC_VER
+	_InterlockedExchangePointer(_value, _new);
+#else
+	__atomic_store_n(_value, _new, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void AtomicFence(void)
+{
+#ifdef _MSC_VER
+	__faststorefence();
+#else
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+// Hint for spin loops
+static inline void AtomicPause(void)
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#endif
+}
+#pragma endregion
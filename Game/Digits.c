@@ -0,0 +1,163 @@
+#include "Track.h"
+#include "Digits.h"
+
+// Transparent gap between two glyphs so filtering never bleeds
+#define PADDING 1
+
+bool DigitFontCreate(DigitFont* const _digits, sfFont* _font, unsigned int _characterSize)
+{
+	*_digits = (DigitFont){ 0 };
+	if (!_font)
+	{
+		return false;
+	}
+
+	// Loading the glyphs rasterises them into the font page of this size
+	sfGlyph glyphs[DIGIT_COUNT];
+	int width = PADDING;
+	int height = 0;
+	for (int i = 0; i < DIGIT_COUNT; i++)
+	{
+		glyphs[i] = sfFont_getGlyph(_font, '0' + i, _characterSize, sfFalse, 0);
+		width += glyphs[i].textureRect.width + PADDING;
+		height = glyphs[i].textureRect.height > height ? glyphs[i].textureRect.height : height;
+	}
+	height += PADDING * 2;
+
+	// Copied out of the page, which can be regrown or shared with other texts
+	sfImage* page = sfTexture_copyToImage(sfFont_getTexture(_font, _characterSize));
+	sfImage* atlas = sfImage_createFromColor(width, height, sfTransparent);
+	if (!page || !atlas)
+	{
+		if (page)
+		{
+			sfImage_destroy(page);
+		}
+		if (atlas)
+		{
+			sfImage_destroy(atlas);
+		}
+		return false;
+	}
+
+	int x = PADDING;
+	for (int i = 0; i < DIGIT_COUNT; i++)
+	{
+		sfIntRect source = glyphs[i].textureRect;
+		sfImage_copyImage(atlas, page, x, PADDING, source, sfFalse);
+		_digits->rects[i] = (sfIntRect){ x, PADDING, source.width, source.height };
+		_digits->bounds[i] = glyphs[i].bounds;
+		_digits->advances[i] = glyphs[i].advance;
+		x += source.width + PADDING;
+	}
+	_digits->texture = TRACK_CREATE(TRACK_TEXTURE, sfTexture_createFromImage(atlas, NULL));
+	sfImage_destroy(page);
+	sfImage_destroy(atlas);
+	if (!_digits->texture)
+	{
+		return false;
+	}
+	sfTexture_setSmooth(_digits->texture, sfTrue);
+	return true;
+}
+
+void DigitFontDestroy(DigitFont* const _digits)
+{
+	if (_digits->texture)
+	{
+		TRACK_DESTROY(TRACK_TEXTURE, sfTexture_destroy, _digits->texture);
+		_digits->texture = NULL;
+	}
+}
+
+bool DigitTextCreate(DigitText* const _text)
+{
+	*_text = (DigitText){ 0 };
+	_text->vertices = sfVertexArray_create();
+	if (!_text->vertices)
+	{
+		return false;
+	}
+	sfVertexArray_setPrimitiveType(_text->vertices, sfQuads);
+	return true;
+}
+
+void DigitTextDestroy(DigitText* const _text)
+{
+	if (_text->vertices)
+	{
+		sfVertexArray_destroy(_text->vertices);
+		_text->vertices = NULL;
+	}
+}
+
+void DigitTextSet(DigitText* const _text, const DigitFont* const _digits, uint64_t _value, sfVector2f _center)
+{
+	_text->value = _value;
+	_text->center = _center;
+
+	// Digits come out lowest first
+	int digits[DIGIT_MAX_LENGTH];
+	int length = 0;
+	do
+	{
+		digits[length++] = (int)(_value % 10);
+		_value /= 10;
+	} while (_value);
+
+	// Ink box of the whole number, pen starting at 0 on the baseline
+	float pen = 0;
+	float left = 0;
+	float right = 0;
+	float top = 0;
+	float bottom = 0;
+	for (int i = length - 1; i >= 0; i--)
+	{
+		sfFloatRect bounds = _digits->bounds[digits[i]];
+		float glyphLeft = pen + bounds.left;
+		float glyphRight = glyphLeft + bounds.width;
+		bool isFirst = i == length - 1;
+		left = isFirst || glyphLeft < left ? glyphLeft : left;
+		right = isFirst || glyphRight > right ? glyphRight : right;
+		top = isFirst || bounds.top < top ? bounds.top : top;
+		bottom = isFirst || bounds.top + bounds.height > bottom ? bounds.top + bounds.height : bottom;
+		pen += _digits->advances[digits[i]];
+	}
+
+	// Whole pixels keep the glyphs as sharp as they were rasterised
+	float originX = (float)(int)(_center.x - (left + right) / 2);
+	float originY = (float)(int)(_center.y - (top + bottom) / 2);
+
+	sfVertexArray_resize(_text->vertices, length * 4);
+	pen = originX;
+	for (int i = length - 1, quad = 0; i >= 0; i--, quad++)
+	{
+		int digit = digits[i];
+		sfFloatRect bounds = _digits->bounds[digit];
+		sfIntRect rect = _digits->rects[digit];
+		float x = pen + bounds.left;
+		float y = originY + bounds.top;
+		sfVector2f positions[4] =
+		{
+			{ x, y },
+			{ x + bounds.width, y },
+			{ x + bounds.width, y + bounds.height },
+			{ x, y + bounds.height },
+		};
+		sfVector2f texCoords[4] =
+		{
+			{ (float)rect.left, (float)rect.top },
+			{ (float)(rect.left + rect.width), (float)rect.top },
+			{ (float)(rect.left + rect.width), (float)(rect.top + rect.height) },
+			{ (float)rect.left, (float)(rect.top + rect.height) },
+		};
+		for (int corner = 0; corner < 4; corner++)
+		{
+			sfVertex* vertex = sfVertexArray_getVertex(_text->vertices, quad * 4 + corner);
+			vertex->position = positions[corner];
+			vertex->texCoords = texCoords[corner];
+			vertex->color = sfWhite;
+		}
+		pen += _digits->advances[digit];
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <SFML/Graphics.h>
+
+// Number renderer for the score: the glyphs 0-9 are rasterised once into a
+// small atlas, then a number is only a few quads in a vertex array. No
+// string formatting and no text layout, and no limit on the digit count.
+
+#pragma region Define
+#define DIGIT_COUNT 10
+// uint64_t has at most 20 digits
+#define DIGIT_MAX_LENGTH 20
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct DigitFont
+{
+	sfTexture* texture;
+	sfIntRect rects[DIGIT_COUNT];
+	// Glyph bounds relative to the pen on the baseline
+	sfFloatRect bounds[DIGIT_COUNT];
+	float advances[DIGIT_COUNT];
+}DigitFont;
+
+typedef struct DigitText
+{
+	sfVertexArray* vertices;
+	uint64_t value;
+	sfVector2f center;
+}DigitText;
+#pragma endregion
+
+#pragma region Definition
+// The font is only read here, it can be destroyed afterwards
+bool DigitFontCreate(DigitFont* const _digits, sfFont* _font, unsigned int _characterSize);
+void DigitFontDestroy(DigitFont* const _digits);
+
+bool DigitTextCreate(DigitText* const _text);
+void DigitTextDestroy(DigitText* const _text);
+// Rebuilds the quads with the ink of the number centred on _center
+void DigitTextSet(DigitText* const _text, const DigitFont* const _digits, uint64_t _value, sfVector2f _center);
+#pragma endregion
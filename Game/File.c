@@ -0,0 +1,15 @@
+#include "File.h"
+
+FILE* FileOpen(const char* _path, const char* _mode)
+{
+#ifdef _MSC_VER
+	FILE* file = NULL;
+	if (fopen_s(&file, _path, _mode) != 0)
+	{
+		return NULL;
+	}
+	return file;
+#else
+	return fopen(_path, _mode);
+#endif
+}
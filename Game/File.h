@@ -0,0 +1,15 @@
+#pragma once
+#include <stdio.h>
+
+// fopen wrapper: fopen is rejected by the MSVC SDL checks, fopen_s does not exist elsewhere
+FILE* FileOpen(const char* _path, const char* _mode);
+
+// sscanf wrapper for the same reason: sscanf_s wants the size after every %s buffer and sscanf must not get it,
+// so string buffers (arrays only) are passed as FILE_SCAN_STRING(buffer)
+#ifdef _MSC_VER
+#define FileScan sscanf_s
+#define FILE_SCAN_STRING(_buffer) _buffer, (unsigned int)sizeof(_buffer)
+#else
+#define FileScan sscanf
+#define FILE_SCAN_STRING(_buffer) _buffer
+#endif
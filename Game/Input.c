@@ -0,0 +1,121 @@
+#include <string.h>
+#include "Input.h"
+#include "Atomic.h"
+#include "Timer.h"
+#include "Profile.h"
+
+bool InputPush(InputSampler* const _input, InputType _type, int64_t _time)
+{
+	int32_t head = _input->head;
+	if (head - AtomicLoad32(&_input->tail) >= INPUT_RING_SIZE)
+	{
+		_input->droppedCount++;
+		return false;
+	}
+
+	_input->events[head & (INPUT_RING_SIZE - 1)] = (InputEvent){ _time, _type };
+	AtomicStore32(&_input->head, head + 1);
+	return true;
+}
+
+static void Sample(InputSampler* const _input)
+{
+	bool isLeft = false;
+	bool isRight = false;
+	bool isButton = false;
+
+	if (AtomicLoad32(&_input->hasFocus))
+	{
+		isLeft = sfKeyboard_isKeyPressed(sfKeyQ) || sfKeyboard_isKeyPressed(sfKeyLeft);
+		isRight = sfKeyboard_isKeyPressed(sfKeyD) || sfKeyboard_isKeyPressed(sfKeyRight);
+	}
+
+	// Stick, hat or any button: the first press starts the game
+	sfJoystick_update();
+	for (unsigned int i = 0; i < sfJoystickCount; i++)
+	{
+		if (!sfJoystick_isConnected(i))
+		{
+			continue;
+		}
+		float axis = sfJoystick_getAxisPosition(i, sfJoystickX) + sfJoystick_getAxisPosition(i, sfJoystickPovX);
+		isLeft |= axis < -INPUT_AXIS_THRESHOLD;
+		isRight |= axis > INPUT_AXIS_THRESHOLD;
+		for (unsigned int button = 0; button < sfJoystick_getButtonCount(i); button++)
+		{
+			isButton |= sfJoystick_isButtonPressed(i, button) != sfFalse;
+		}
+	}
+
+	// Only the press is an event, holding a key does not chop again
+	int64_t time = TimerTicks();
+	if (isLeft && !_input->wasLeft)
+	{
+		InputPush(_input, INPUT_CHOP_LEFT, time);
+	}
+	if (isRight && !_input->wasRight)
+	{
+		InputPush(_input, INPUT_CHOP_RIGHT, time);
+	}
+	if (isButton && !_input->wasButton)
+	{
+		InputPush(_input, INPUT_START, time);
+	}
+	_input->wasLeft = isLeft;
+	_input->wasRight = isRight;
+	_input->wasButton = isButton;
+}
+
+static void InputThread(void* _input)
+{
+	InputSampler* const input = _input;
+	ProfileSetThreadName("input");
+	sfTime period = sfMicroseconds(1000000 / INPUT_SAMPLE_RATE);
+	while (AtomicLoad32(&input->isRunning))
+	{
+		Sample(input);
+		sfSleep(period);
+	}
+}
+
+bool InputStart(InputSampler* const _input)
+{
+	memset(_input, 0, sizeof(*_input));
+	_input->hasFocus = 1;
+	_input->isRunning = 1;
+	if (!ThreadStart(&_input->thread, InputThread, _input))
+	{
+		_input->isRunning = 0;
+		return false;
+	}
+	return true;
+}
+
+void InputStop(InputSampler* const _input)
+{
+	if (AtomicExchange32(&_input->isRunning, 0))
+	{
+		ThreadWait(&_input->thread);
+	}
+}
+
+void InputSetFocus(InputSampler* const _input, bool _hasFocus)
+{
+	AtomicStore32(&_input->hasFocus, _hasFocus);
+}
+
+bool InputPeek(InputSampler* const _input, InputEvent* const _event)
+{
+	int32_t tail = _input->tail;
+	if (tail == AtomicLoad32(&_input->head))
+	{
+		return false;
+	}
+	*_event = _input->events[tail & (INPUT_RING_SIZE - 1)];
+	return true;
+}
+
+void InputPop(InputSampler* const _input)
+{
+	AtomicStore32(&_input->tail, _input->tail + 1);
+}
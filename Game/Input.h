@@ -0,0 +1,62 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <SFML/Window.h>
+#include "Thread.h"
+
+// Samples the chop controls (keyboard and joysticks) on a thread of its own,
+// far more often than the frame rate. Every press is stamped with TimerTicks
+// and handed to the simulation through a lock-free single-producer
+// single-consumer ring, so the simulation can apply it at the exact tick.
+
+#pragma region Define
+#define INPUT_SAMPLE_RATE 1000
+// Power of two
+#define INPUT_RING_SIZE 256
+#define INPUT_AXIS_THRESHOLD 50.f
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum InputType
+{
+	INPUT_CHOP_LEFT,
+	INPUT_CHOP_RIGHT,
+	INPUT_START,
+}InputType;
+
+typedef struct InputEvent
+{
+	int64_t time;
+	InputType type;
+}InputEvent;
+
+typedef struct InputSampler
+{
+	Thread thread;
+	InputEvent events[INPUT_RING_SIZE];
+	// head is only written by the sampler, tail by the consumer
+	volatile int32_t head;
+	volatile int32_t tail;
+	volatile int32_t isRunning;
+	// Written by the window thread, keys are ignored while the window is in the background
+	volatile int32_t hasFocus;
+	// Sampler side only
+	bool wasLeft;
+	bool wasRight;
+	bool wasButton;
+	int droppedCount;
+}InputSampler;
+#pragma endregion
+
+#pragma region Definition
+bool InputStart(InputSampler* const _input);
+void InputStop(InputSampler* const _input);
+void InputSetFocus(InputSampler* const _input, bool _hasFocus);
+
+// Producer side: the sampler thread, or a test driver when the thread was not started
+bool InputPush(InputSampler* const _input, InputType _type, int64_t _time);
+
+// Consumer side: look at the oldest event without removing it, then pop it
+bool InputPeek(InputSampler* const _input, InputEvent* const _event);
+void InputPop(InputSampler* const _input);
+#pragma endregion
@@ -0,0 +1,386 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Job.h"
+#include "Atomic.h"
+
+// Worker index of the current thread in the system it belongs to
+static THREAD_LOCAL JobSystem* currentJobs = NULL;
+static THREAD_LOCAL int currentWorker = -1;
+
+#pragma region Deque
+static bool DequePush(JobDeque* const _deque, const Job* const _job)
+{
+	int64_t bottom = _deque->bottom;
+	int64_t top = AtomicLoad64(&_deque->top);
+	if (bottom - top >= JOB_DEQUE_SIZE)
+	{
+		return false;
+	}
+
+	_deque->jobs[bottom & (JOB_DEQUE_SIZE - 1)] = *_job;
+	AtomicStore64(&_deque->bottom, bottom + 1);
+	return true;
+}
+
+static bool DequePop(JobDeque* const _deque, Job* const _job)
+{
+	int64_t bottom = _deque->bottom - 1;
+	AtomicStore64(&_deque->bottom, bottom);
+	int64_t top = AtomicLoad64(&_deque->top);
+	if (top > bottom)
+	{
+		AtomicStore64(&_deque->bottom, bottom + 1);
+		return false;
+	}
+
+	*_job = _deque->jobs[bottom & (JOB_DEQUE_SIZE - 1)];
+	if (top == bottom)
+	{
+		// Last job: race the thieves for it
+		bool isWon = AtomicCompareExchange64(&_deque->top, top, top + 1);
+		AtomicStore64(&_deque->bottom, bottom + 1);
+		return isWon;
+	}
+	return true;
+}
+
+static bool DequeSteal(JobDeque* const _deque, Job* const _job)
+{
+	int64_t top = AtomicLoad64(&_deque->top);
+	int64_t bottom = AtomicLoad64(&_deque->bottom);
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	// The owner can not reuse this slot before top moves, the copy is only kept if the exchange wins
+	*_job = _deque->jobs[top & (JOB_DEQUE_SIZE - 1)];
+	return AtomicCompareExchange64(&_deque->top, top, top + 1);
+}
+#pragma endregion
+
+#pragma region Queue
+static void QueueInit(JobQueue* const _queue)
+{
+	for (int i = 0; i < JOB_QUEUE_SIZE; i++)
+	{
+		_queue->cells[i].sequence = i;
+	}
+	_queue->head = 0;
+	_queue->tail = 0;
+}
+
+static bool QueuePush(JobQueue* const _queue, const Job* const _job)
+{
+	int64_t tail = AtomicLoad64(&_queue->tail);
+	for (;;)
+	{
+		JobQueueCell* cell = &_queue->cells[tail & (JOB_QUEUE_SIZE - 1)];
+		int64_t difference = AtomicLoad64(&cell->sequence) - tail;
+		if (difference == 0)
+		{
+			if (AtomicCompareExchange64(&_queue->tail, tail, tail + 1))
+			{
+				cell->job = *_job;
+				AtomicStore64(&cell->sequence, tail + 1);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		tail = AtomicLoad64(&_queue->tail);
+	}
+}
+
+static bool QueuePop(JobQueue* const _queue, Job* const _job)
+{
+	int64_t head = AtomicLoad64(&_queue->head);
+	for (;;)
+	{
+		JobQueueCell* cell = &_queue->cells[head & (JOB_QUEUE_SIZE - 1)];
+		int64_t difference = AtomicLoad64(&cell->sequence) - (head + 1);
+		if (difference == 0)
+		{
+			if (AtomicCompareExchange64(&_queue->head, head, head + 1))
+			{
+				*_job = cell->job;
+				AtomicStore64(&cell->sequence, head + JOB_QUEUE_SIZE);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		head = AtomicLoad64(&_queue->head);
+	}
+}
+#pragma endregion
+
+#pragma region Worker
+static int CurrentWorker(const JobSystem* const _jobs)
+{
+	return currentJobs == _jobs ? currentWorker : -1;
+}
+
+static void RunJob(JobSystem* const _jobs, int _worker, const Job* const _job)
+{
+	if (_worker >= 0)
+	{
+		_jobs->workers[_worker].executedCount++;
+	}
+	_job->function(_jobs, _job->counter, _job->data);
+	if (_job->counter)
+	{
+		AtomicAdd32(&_job->counter->pending, -1);
+	}
+}
+
+static bool FindJob(JobSystem* const _jobs, int _worker, Job* const _job)
+{
+	JobWorker* self = _worker >= 0 ? &_jobs->workers[_worker] : NULL;
+	if (self && DequePop(&self->deque, _job))
+	{
+		return true;
+	}
+	if (QueuePop(&_jobs->queue, _job))
+	{
+		return true;
+	}
+
+	// Start at a random victim so thieves do not all hit the same deque
+	uint32_t start = 0;
+	if (self)
+	{
+		self->victimSeed = self->victimSeed * 1664525u + 1013904223u;
+		start = self->victimSeed >> 16;
+	}
+	for (int i = 0; i < _jobs->workerCount; i++)
+	{
+		int victim = (int)((start + i) % (uint32_t)_jobs->workerCount);
+		if (victim != _worker && DequeSteal(&_jobs->workers[victim].deque, _job))
+		{
+			if (self)
+			{
+				self->stolenCount++;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+static void WorkerRun(void* _worker)
+{
+	JobWorker* worker = _worker;
+	JobSystem* jobs = worker->jobs;
+	currentJobs = jobs;
+	currentWorker = worker->index;
+
+	Job job;
+	int idleCount = 0;
+	while (AtomicLoad32(&jobs->isRunning))
+	{
+		if (FindJob(jobs, worker->index, &job))
+		{
+			RunJob(jobs, worker->index, &job);
+			idleCount = 0;
+		}
+		else if (++idleCount < JOB_SPIN_COUNT)
+		{
+			AtomicPause();
+		}
+		else
+		{
+			// Announce the sleep before the last look so a submit in between always wakes us
+			AtomicAdd32(&jobs->sleepingCount, 1);
+			if (FindJob(jobs, worker->index, &job))
+			{
+				AtomicAdd32(&jobs->sleepingCount, -1);
+				RunJob(jobs, worker->index, &job);
+			}
+			else
+			{
+				SemaphoreWait(&jobs->wakeup);
+				AtomicAdd32(&jobs->sleepingCount, -1);
+			}
+			idleCount = 0;
+		}
+	}
+}
+#pragma endregion
+
+bool JobSystemCreate(JobSystem* const _jobs, int _workerCount)
+{
+	memset(_jobs, 0, sizeof(*_jobs));
+	if (_workerCount <= 0)
+	{
+		_workerCount = ThreadHardwareCount();
+	}
+	if (_workerCount > JOB_MAX_WORKERS)
+	{
+		_workerCount = JOB_MAX_WORKERS;
+	}
+
+	_jobs->workers = calloc(_workerCount, sizeof(JobWorker));
+	if (!_jobs->workers || !SemaphoreCreate(&_jobs->wakeup))
+	{
+		free(_jobs->workers);
+		_jobs->workers = NULL;
+		return false;
+	}
+	QueueInit(&_jobs->queue);
+	_jobs->isRunning = 1;
+
+	// Worker 0 is the calling thread. The count is final before any thread starts reading it.
+	currentJobs = _jobs;
+	currentWorker = 0;
+	_jobs->workerCount = _workerCount;
+	_jobs->workers[0].jobs = _jobs;
+	for (int i = 1; i < _workerCount; i++)
+	{
+		JobWorker* worker = &_jobs->workers[i];
+		worker->jobs = _jobs;
+		worker->index = i;
+		worker->victimSeed = (uint32_t)i * 2654435761u;
+	}
+	for (int i = 1; i < _workerCount; i++)
+	{
+		if (!ThreadStart(&_jobs->workers[i].thread, WorkerRun, &_jobs->workers[i]))
+		{
+			_jobs->workerCount = i;
+			JobSystemDestroy(_jobs);
+			return false;
+		}
+	}
+	return true;
+}
+
+void JobSystemDestroy(JobSystem* const _jobs)
+{
+	if (!_jobs->workers)
+	{
+		return;
+	}
+
+	AtomicStore32(&_jobs->isRunning, 0);
+	SemaphorePost(&_jobs->wakeup, _jobs->workerCount);
+	for (int i = 1; i < _jobs->workerCount; i++)
+	{
+		ThreadWait(&_jobs->workers[i].thread);
+	}
+
+	SemaphoreDestroy(&_jobs->wakeup);
+	free(_jobs->workers);
+	_jobs->workers = NULL;
+	if (currentJobs == _jobs)
+	{
+		currentJobs = NULL;
+		currentWorker = -1;
+	}
+}
+
+void JobSubmit(JobSystem* const _jobs, JobFunction _function, void* _data, JobCounter* const _counter)
+{
+	Job job = { _function, _data, _counter };
+	if (_counter)
+	{
+		AtomicAdd32(&_counter->pending, 1);
+	}
+
+	// Without a working system (creation failed) everything runs inline
+	int worker = CurrentWorker(_jobs);
+	if (!_jobs->workers)
+	{
+		RunJob(_jobs, -1, &job);
+		return;
+	}
+	bool isQueued = worker >= 0 ? DequePush(&_jobs->workers[worker].deque, &job) : QueuePush(&_jobs->queue, &job);
+	if (!isQueued)
+	{
+		RunJob(_jobs, worker, &job);
+		return;
+	}
+
+	if (AtomicLoad32(&_jobs->sleepingCount) > 0)
+	{
+		SemaphorePost(&_jobs->wakeup, 1);
+	}
+}
+
+void JobWait(JobSystem* const _jobs, JobCounter* const _counter)
+{
+	int worker = CurrentWorker(_jobs);
+	Job job;
+	while (AtomicLoad32(&_counter->pending) > 0)
+	{
+		// Help instead of blocking, the job we wait for may be in our own deque
+		if (FindJob(_jobs, worker, &job))
+		{
+			RunJob(_jobs, worker, &job);
+		}
+		else
+		{
+			AtomicPause();
+		}
+	}
+}
+
+bool JobIsDone(const JobCounter* const _counter)
+{
+	return AtomicLoad32((volatile int32_t*)&_counter->pending) == 0;
+}
+
+bool JobRunPhases(JobSystem* const _jobs, JobPhase* const _phases, int _count)
+{
+	// One bit per phase in the masks below
+	if (_count < 0 || _count > JOB_MAX_PHASES)
+	{
+		return false;
+	}
+
+	uint32_t submitted = 0;
+	uint32_t done = 0;
+	uint32_t all = _count == JOB_MAX_PHASES ? 0xFFFFFFFFu : (1u << _count) - 1;
+	for (int i = 0; i < _count; i++)
+	{
+		_phases[i].counter.pending = 0;
+	}
+
+	int worker = CurrentWorker(_jobs);
+	Job job;
+	while (done != all)
+	{
+		bool isProgress = false;
+		for (int i = 0; i < _count; i++)
+		{
+			uint32_t bit = 1u << i;
+			if (!(submitted & bit) && (_phases[i].dependencies & done) == _phases[i].dependencies)
+			{
+				JobSubmit(_jobs, _phases[i].function, _phases[i].data, &_phases[i].counter);
+				submitted |= bit;
+				isProgress = true;
+			}
+			else if ((submitted & bit) && !(done & bit) && JobIsDone(&_phases[i].counter))
+			{
+				done |= bit;
+				isProgress = true;
+			}
+		}
+
+		if (!isProgress)
+		{
+			if (FindJob(_jobs, worker, &job))
+			{
+				RunJob(_jobs, worker, &job);
+			}
+			else
+			{
+				AtomicPause();
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "Thread.h"
+
+// Work-stealing job system. Every worker owns a deque: it pushes and pops its
+// own jobs at the bottom while idle workers steal from the top. Threads that
+// are not workers submit into a shared injection queue. The thread that
+// creates the system is worker 0: it runs jobs while it waits on a counter.
+
+#pragma region Define
+// Both sizes must be powers of two, a full queue runs the job inline
+#define JOB_DEQUE_SIZE 4096
+#define JOB_QUEUE_SIZE 1024
+#define JOB_MAX_WORKERS 64
+#define JOB_SPIN_COUNT 256
+#define JOB_MAX_PHASES 32
+#define JOB_CACHE_LINE 64
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct JobSystem JobSystem;
+
+// Number of jobs not finished yet, jobs may add children to their own counter
+typedef struct JobCounter
+{
+	volatile int32_t pending;
+}JobCounter;
+
+typedef void (*JobFunction)(JobSystem* _jobs, JobCounter* _counter, void* _data);
+
+typedef struct Job
+{
+	JobFunction function;
+	void* data;
+	JobCounter* counter;
+}Job;
+
+// Chase-Lev deque, top and bottom on their own cache lines
+typedef struct JobDeque
+{
+	volatile int64_t top;
+	char topPadding[JOB_CACHE_LINE - sizeof(int64_t)];
+	volatile int64_t bottom;
+	char bottomPadding[JOB_CACHE_LINE - sizeof(int64_t)];
+	Job jobs[JOB_DEQUE_SIZE];
+}JobDeque;
+
+// Bounded multi-producer multi-consumer queue (Vyukov)
+typedef struct JobQueueCell
+{
+	volatile int64_t sequence;
+	Job job;
+}JobQueueCell;
+
+typedef struct JobQueue
+{
+	volatile int64_t head;
+	char headPadding[JOB_CACHE_LINE - sizeof(int64_t)];
+	volatile int64_t tail;
+	char tailPadding[JOB_CACHE_LINE - sizeof(int64_t)];
+	JobQueueCell cells[JOB_QUEUE_SIZE];
+}JobQueue;
+
+typedef struct JobWorker
+{
+	JobDeque deque;
+	Thread thread;
+	JobSystem* jobs;
+	int index;
+	uint32_t victimSeed;
+	// Only written by the worker itself
+	long long executedCount;
+	long long stolenCount;
+}JobWorker;
+
+struct JobSystem
+{
+	JobWorker* workers;
+	int workerCount;
+	JobQueue queue;
+	Semaphore wakeup;
+	volatile int32_t sleepingCount;
+	volatile int32_t isRunning;
+};
+
+// A frame phase runs once all the phases in its dependency mask are done
+typedef struct JobPhase
+{
+	const char* name;
+	JobFunction function;
+	void* data;
+	// Bit i set: waits for phase i of the same list
+	uint32_t dependencies;
+	JobCounter counter;
+}JobPhase;
+#pragma endregion
+
+#pragma region Definition
+// _workerCount includes the calling thread, 0 picks one per hardware thread
+bool JobSystemCreate(JobSystem* const _jobs, int _workerCount);
+void JobSystemDestroy(JobSystem* const _jobs);
+
+void JobSubmit(JobSystem* const _jobs, JobFunction _function, void* _data, JobCounter* const _counter);
+void JobWait(JobSystem* const _jobs, JobCounter* const _counter);
+bool JobIsDone(const JobCounter* const _counter);
+
+// Only from the thread that created the system, one phase list at a time: the wait runs any job it finds,
+// so a second runner would execute the other's phases and each would wait on the other's work.
+// At most JOB_MAX_PHASES phases, the dependencies are a 32 bit mask: false and nothing runs otherwise.
+bool JobRunPhases(JobSystem* const _jobs, JobPhase* const _phases, int _count);
+#pragma endregion
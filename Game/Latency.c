@@ -0,0 +1,114 @@
+#include "Latency.h"
+#include "Atomic.h"
+#include "Timer.h"
+
+static const float percentiles[] = { 50, 95, 99 };
+#define PERCENTILE_COUNT (int)(sizeof(percentiles) / sizeof(percentiles[0]))
+
+void LatencyRecord(Latency* const _latency, LatencyStage _stage, int64_t _ticks)
+{
+	LatencyHistogram* const histogram = &_latency->stages[_stage];
+	int64_t micro = _ticks > 0 ? _ticks * 1000000 / TimerFrequency() : 0;
+	int32_t clamped = micro < INT32_MAX ? (int32_t)micro : INT32_MAX;
+	int bin = micro / LATENCY_BIN_US < LATENCY_BIN_COUNT ? (int)(micro / LATENCY_BIN_US) : LATENCY_BIN_COUNT - 1;
+
+	AtomicAdd32(&histogram->bins[bin], 1);
+	AtomicAdd32(&histogram->count, 1);
+	int32_t max = AtomicLoad32(&histogram->max);
+	while (clamped > max && !AtomicCompareExchange32(&histogram->max, max, clamped))
+	{
+		max = AtomicLoad32(&histogram->max);
+	}
+}
+
+int LatencyCount(const Latency* const _latency, LatencyStage _stage)
+{
+	return _latency->stages[_stage].count;
+}
+
+float LatencyPercentile(const Latency* const _latency, LatencyStage _stage, float _percentile)
+{
+	const LatencyHistogram* const histogram = &_latency->stages[_stage];
+	if (histogram->count == 0)
+	{
+		return 0;
+	}
+
+	// Rank of the sample, then the bin that holds it
+	int64_t rank = (int64_t)(_percentile / 100.f * histogram->count + 0.5f);
+	rank = rank < 1 ? 1 : rank;
+	int64_t seen = 0;
+	for (int bin = 0; bin < LATENCY_BIN_COUNT; bin++)
+	{
+		seen += histogram->bins[bin];
+		if (seen >= rank)
+		{
+			return (bin + 1) * LATENCY_BIN_US / 1000.f;
+		}
+	}
+	return LATENCY_BIN_COUNT * LATENCY_BIN_US / 1000.f;
+}
+
+const char* LatencyStageName(LatencyStage _stage)
+{
+	switch (_stage)
+	{
+	case LATENCY_INPUT_TO_TICK:
+		return "inputToTick";
+	case LATENCY_TICK_TO_DISPLAY:
+		return "tickToDisplay";
+	case LATENCY_INPUT_TO_DISPLAY:
+		return "inputToDisplay";
+	default:
+		return "unknown";
+	}
+}
+
+void LatencyWriteSummary(FILE* _file, const Latency* const _latency)
+{
+	fprintf(_file, "%-16s %8s", "latency (ms)", "count");
+	for (int p = 0; p < PERCENTILE_COUNT; p++)
+	{
+		fprintf(_file, " %7s%g", "p", percentiles[p]);
+	}
+	fprintf(_file, " %9s\n", "max");
+
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++)
+	{
+		fprintf(_file, "%-16s %8d", LatencyStageName(stage), LatencyCount(_latency, stage));
+		for (int p = 0; p < PERCENTILE_COUNT; p++)
+		{
+			fprintf(_file, " %9.1f", LatencyPercentile(_latency, stage, percentiles[p]));
+		}
+		fprintf(_file, " %9.1f\n", _latency->stages[stage].max / 1000.f);
+	}
+}
+
+void LatencyWriteJson(FILE* _file, const Latency* const _latency)
+{
+	fprintf(_file, "{\n\t\"binWidthMs\": %g,\n\t\"stages\": [", LATENCY_BIN_US / 1000.f);
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++)
+	{
+		const LatencyHistogram* const histogram = &_latency->stages[stage];
+		fprintf(_file, "%s\n\t\t{\n\t\t\t\"name\": \"%s\",\n\t\t\t\"count\": %d,\n\t\t\t\"maxMs\": %.3f,\n\t\t\t\"percentilesMs\": {",
+			stage ? "," : "", LatencyStageName(stage), histogram->count, histogram->max / 1000.f);
+		for (int p = 0; p < PERCENTILE_COUNT; p++)
+		{
+			fprintf(_file, "%s\"p%g\": %.1f", p ? ", " : " ", percentiles[p], LatencyPercentile(_latency, stage, percentiles[p]));
+		}
+
+		// Trailing empty bins are left out
+		int last = -1;
+		for (int bin = 0; bin < LATENCY_BIN_COUNT; bin++)
+		{
+			last = histogram->bins[bin] ? bin : last;
+		}
+		fprintf(_file, " },\n\t\t\t\"histogram\": [");
+		for (int bin = 0; bin <= last; bin++)
+		{
+			fprintf(_file, "%s%d", bin ? ", " : "", histogram->bins[bin]);
+		}
+		fprintf(_file, "]\n\t\t}");
+	}
+	fprintf(_file, "\n\t]\n}\n");
+}
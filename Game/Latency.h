@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+// Input-to-photon latency of the chops, split in stages. Each stage is a
+// fixed histogram filled with atomic adds, so the simulation and the render
+// thread can both record without a lock. Durations are TimerTicks.
+
+#pragma region Define
+// 0.1 ms bins up to 250 ms, slower samples land in the last bin
+#define LATENCY_BIN_US 100
+#define LATENCY_BIN_COUNT 2500
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum LatencyStage
+{
+	// Sampled by the input thread to the tick that applied it
+	LATENCY_INPUT_TO_TICK,
+	// That tick to the display of the first frame showing it
+	LATENCY_TICK_TO_DISPLAY,
+	LATENCY_INPUT_TO_DISPLAY,
+	LATENCY_STAGE_COUNT,
+}LatencyStage;
+
+typedef struct LatencyHistogram
+{
+	volatile int32_t bins[LATENCY_BIN_COUNT];
+	volatile int32_t count;
+	// Microseconds
+	volatile int32_t max;
+}LatencyHistogram;
+
+typedef struct Latency
+{
+	LatencyHistogram stages[LATENCY_STAGE_COUNT];
+}Latency;
+#pragma endregion
+
+#pragma region Definition
+void LatencyRecord(Latency* const _latency, LatencyStage _stage, int64_t _ticks);
+int LatencyCount(const Latency* const _latency, LatencyStage _stage);
+// Milliseconds, upper edge of the bin holding the percentile
+float LatencyPercentile(const Latency* const _latency, LatencyStage _stage, float _percentile);
+const char* LatencyStageName(LatencyStage _stage);
+
+void LatencyWriteSummary(FILE* _file, const Latency* const _latency);
+void LatencyWriteJson(FILE* _file, const Latency* const _latency);
+#pragma endregion
@@ -0,0 +1,79 @@
+#include "Track.h"
+#include "Layer.h"
+
+bool StaticLayerCreate(StaticLayer* const _layer, sfVector2f _size, sfBool _isOpaque)
+{
+	*_layer = (StaticLayer){ 0 };
+	_layer->size = _size;
+	_layer->isOpaque = _isOpaque;
+	_layer->version = UINT32_MAX;
+	_layer->sprite = TRACK_CREATE(TRACK_SPRITE, sfSprite_create());
+	return _layer->sprite != NULL;
+}
+
+void StaticLayerDestroy(StaticLayer* const _layer)
+{
+	if (_layer->sprite)
+	{
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _layer->sprite);
+		_layer->sprite = NULL;
+	}
+	if (_layer->texture)
+	{
+		sfRenderTexture_destroy(_layer->texture);
+		_layer->texture = NULL;
+	}
+	_layer->isValid = sfFalse;
+}
+
+bool StaticLayerIsStale(const StaticLayer* const _layer, uint32_t _version)
+{
+	return _layer->version != _version;
+}
+
+bool StaticLayerBegin(StaticLayer* const _layer, uint32_t _version, sfVector2u _resolution)
+{
+	_layer->version = _version;
+	_layer->isValid = sfFalse;
+	sfBool isResized = !_layer->texture;
+	if (_layer->texture)
+	{
+		sfVector2u size = sfRenderTexture_getSize(_layer->texture);
+		isResized = size.x != _resolution.x || size.y != _resolution.y;
+	}
+
+	// One texel per window pixel, the quad is scaled back to the world area
+	if (isResized)
+	{
+		if (_layer->texture)
+		{
+			sfRenderTexture_destroy(_layer->texture);
+		}
+		_layer->texture = sfRenderTexture_create(_resolution.x, _resolution.y, sfFalse);
+		if (!_layer->texture)
+		{
+			return false;
+		}
+		const sfTexture* texture = sfRenderTexture_getTexture(_layer->texture);
+		sfSprite_setTexture(_layer->sprite, texture, sfTrue);
+		sfSprite_setScale(_layer->sprite, (sfVector2f) { _layer->size.x / _resolution.x, _layer->size.y / _resolution.y });
+	}
+
+	sfView* view = sfView_createFromRect((sfFloatRect) { 0, 0, _layer->size.x, _layer->size.y });
+	sfRenderTexture_setView(_layer->texture, view);
+	sfView_destroy(view);
+	sfRenderTexture_clear(_layer->texture, sfTransparent);
+	return true;
+}
+
+void StaticLayerEnd(StaticLayer* const _layer)
+{
+	sfRenderTexture_display(_layer->texture);
+	_layer->isValid = sfTrue;
+}
+
+sfRenderStates StaticLayerStates(const StaticLayer* const _layer)
+{
+	// Nothing under an opaque layer can show through, blending would only read it back
+	return (sfRenderStates) { _layer->isOpaque ? sfBlendNone : sfBlendAlpha, sfTransform_Identity, NULL, NULL };
+}
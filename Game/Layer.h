@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <SFML/Graphics.h>
+
+// Static layer: content that does not change from one frame to the next is
+// rendered once into a render texture at the window resolution, then every
+// frame is a single textured quad. An opaque layer that covers the screen
+// also replaces the clear, and is drawn without blending.
+
+#pragma region Struct and Enum
+typedef struct StaticLayer
+{
+	sfRenderTexture* texture;
+	sfSprite* sprite;
+	// World area the layer covers, from the top left corner
+	sfVector2f size;
+	sfBool isOpaque;
+	// Of the last StaticLayerBegin, the layer is stale when the caller's version differs
+	uint32_t version;
+	// The texture holds the content of that version
+	sfBool isValid;
+}StaticLayer;
+#pragma endregion
+
+#pragma region Definition
+bool StaticLayerCreate(StaticLayer* const _layer, sfVector2f _size, sfBool _isOpaque);
+void StaticLayerDestroy(StaticLayer* const _layer);
+
+// A new layer is stale for every version but UINT32_MAX
+bool StaticLayerIsStale(const StaticLayer* const _layer, uint32_t _version);
+// Recreates the texture if the resolution changed, then clears it with the world view.
+// False if the texture could not be created, the layer stays invalid until the next version.
+bool StaticLayerBegin(StaticLayer* const _layer, uint32_t _version, sfVector2u _resolution);
+void StaticLayerEnd(StaticLayer* const _layer);
+sfRenderStates StaticLayerStates(const StaticLayer* const _layer);
+#pragma endregion
@@ -0,0 +1,150 @@
+#include <string.h>
+#include "Atomic.h"
+#include "Profile.h"
+#include "Timer.h"
+#include "Loader.h"
+
+#pragma region Definition
+static void LoadJob(JobSystem* _jobs, JobCounter* _counter, void* _task);
+static void DestroyResult(LoadTask* const _task);
+#pragma endregion
+
+void LoaderCreate(Loader* const _loader, JobSystem* const _jobs, const AssetPack* const _pack)
+{
+	*_loader = (Loader){ 0 };
+	_loader->jobs = _jobs;
+	_loader->pack = _pack;
+}
+
+void LoaderDestroy(Loader* const _loader)
+{
+	// Jobs write their task, none may still be running
+	JobWait(_loader->jobs, &_loader->counter);
+	for (int i = 0; i < _loader->taskCount; i++)
+	{
+		DestroyResult(&_loader->tasks[i]);
+	}
+	_loader->taskCount = 0;
+}
+
+bool LoaderAdd(Loader* const _loader, const char* _name, LoadKind _kind)
+{
+	const AssetEntry* entry = AssetPackFind(_loader->pack, _name);
+	if (!entry || _loader->taskCount == LOADER_MAX_TASKS)
+	{
+		return false;
+	}
+	LoadTask* task = &_loader->tasks[_loader->taskCount++];
+	*task = (LoadTask){ _name, _kind, NULL, entry->size, NULL, 0, 0, 0, _loader };
+	_loader->totalBytes += (int32_t)entry->size;
+	return true;
+}
+
+void LoaderStart(Loader* const _loader)
+{
+	for (int i = 0; i < _loader->taskCount; i++)
+	{
+		JobSubmit(_loader->jobs, LoadJob, &_loader->tasks[i], &_loader->counter);
+	}
+}
+
+bool LoaderIsDone(const Loader* const _loader)
+{
+	return JobIsDone(&_loader->counter);
+}
+
+float LoaderProgress(const Loader* const _loader)
+{
+	if (!_loader->totalBytes)
+	{
+		return 1.f;
+	}
+	return (float)AtomicLoad32((volatile int32_t*)&_loader->doneBytes) / _loader->totalBytes;
+}
+
+const LoadTask* LoaderFind(const Loader* const _loader, const char* _name)
+{
+	for (int i = 0; i < _loader->taskCount; i++)
+	{
+		if (strcmp(_loader->tasks[i].name, _name) == 0)
+		{
+			return &_loader->tasks[i];
+		}
+	}
+	return NULL;
+}
+
+void* LoaderTake(Loader* const _loader, const char* _name)
+{
+	LoadTask* task = (LoadTask*)LoaderFind(_loader, _name);
+	if (!task || !AtomicLoad32(&task->isDone))
+	{
+		return NULL;
+	}
+	void* result = task->result;
+	task->result = NULL;
+	return result;
+}
+
+static void LoadJob(JobSystem* _jobs, JobCounter* _counter, void* _task)
+{
+	// Trace names must outlive the loader, one per kind
+	static const char* names[] = { "LoadData", "LoadImage", "LoadFont", "LoadSound" };
+	LoadTask* task = _task;
+	int64_t begin = ProfileBegin();
+
+	// The checksum is read here too, spread over the workers with the decoding
+	int64_t start = TimerTicks();
+	size_t size = 0;
+	const void* data = AssetPackGet(task->loader->pack, task->name, &size);
+	int64_t read = TimerTicks();
+	void* result = NULL;
+	if (data)
+	{
+		switch (task->kind)
+		{
+		case LOAD_DATA:
+			result = (void*)data;
+			break;
+		case LOAD_IMAGE:
+			result = sfImage_createFromMemory(data, size);
+			break;
+		case LOAD_FONT:
+			result = sfFont_createFromMemory(data, size);
+			break;
+		case LOAD_SOUND:
+			result = sfSoundBuffer_createFromMemory(data, size);
+			break;
+		}
+	}
+	task->ioTime = read - start;
+	task->decodeTime = TimerTicks() - read;
+	task->data = data;
+	task->result = result;
+	AtomicStore32(&task->isDone, 1);
+	AtomicAdd32(&task->loader->doneBytes, (int32_t)task->size);
+	ProfileEnd(names[task->kind], begin);
+}
+
+static void DestroyResult(LoadTask* const _task)
+{
+	if (!_task->result)
+	{
+		return;
+	}
+	switch (_task->kind)
+	{
+	case LOAD_DATA:
+		break;
+	case LOAD_IMAGE:
+		sfImage_destroy(_task->result);
+		break;
+	case LOAD_FONT:
+		sfFont_destroy(_task->result);
+		break;
+	case LOAD_SOUND:
+		sfSoundBuffer_destroy(_task->result);
+		break;
+	}
+	_task->result = NULL;
+}
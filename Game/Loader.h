@@ -0,0 +1,73 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SFML/Graphics.h>
+#include <SFML/Audio.h>
+#include "AssetPack.h"
+#include "Job.h"
+
+// Asynchronous asset loading: every entry is checked and decoded by a job on
+// the worker threads while the main thread keeps the window alive and draws
+// the progress. Nothing here touches OpenGL, images come back decoded and the
+// main thread turns them into textures.
+
+#pragma region Define
+#define LOADER_MAX_TASKS 32
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum LoadKind
+{
+	// Only checked, for what reads straight from the pack later (the music stream)
+	LOAD_DATA,
+	// sfImage, for sfTexture_createFromImage on the thread owning the context
+	LOAD_IMAGE,
+	LOAD_FONT,
+	LOAD_SOUND,
+}LoadKind;
+
+typedef struct LoadTask
+{
+	const char* name;
+	LoadKind kind;
+	const void* data;
+	size_t size;
+	// The decoded object (the data itself for LOAD_DATA), NULL if the entry was corrupt or undecodable
+	void* result;
+	volatile int32_t isDone;
+	// TimerTicks spent reading and checking the entry (the page faults of the mapping land there), then decoding it
+	int64_t ioTime;
+	int64_t decodeTime;
+	// The job only gets the task
+	struct Loader* loader;
+}LoadTask;
+
+typedef struct Loader
+{
+	JobSystem* jobs;
+	const AssetPack* pack;
+	LoadTask tasks[LOADER_MAX_TASKS];
+	int taskCount;
+	JobCounter counter;
+	// Pack bytes of the finished tasks, the progress is in bytes since decoding time follows them
+	volatile int32_t doneBytes;
+	int32_t totalBytes;
+}Loader;
+#pragma endregion
+
+#pragma region Definition
+void LoaderCreate(Loader* const _loader, JobSystem* const _jobs, const AssetPack* const _pack);
+// Destroys every result that was not taken
+void LoaderDestroy(Loader* const _loader);
+// _name must live as long as the loader, false if it is not in the pack or the loader is full
+bool LoaderAdd(Loader* const _loader, const char* _name, LoadKind _kind);
+void LoaderStart(Loader* const _loader);
+
+bool LoaderIsDone(const Loader* const _loader);
+// From 0 to 1
+float LoaderProgress(const Loader* const _loader);
+const LoadTask* LoaderFind(const Loader* const _loader, const char* _name);
+// The caller owns the result, only once the task is done. LOAD_DATA results stay in the pack.
+void* LoaderTake(Loader* const _loader, const char* _name);
+#pragma endregion
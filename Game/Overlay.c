@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "Track.h"
+#include "Overlay.h"
+
+#define MARGIN 6.f
+#define BAR_OFFSET 130.f
+#define BAR_WIDTH 70.f
+// The bars stop at this many budgets
+#define BAR_LIMIT 1.5f
+#define PHASE_SMOOTHING 0.1f
+#define LINE_COUNT (2 + OVERLAY_PHASE_COUNT)
+// Panel, budget line, one bar per frame, then a background and a fill per phase
+#define FIRST_FRAME_QUAD 2
+#define FIRST_PHASE_QUAD (FIRST_FRAME_QUAD + OVERLAY_FRAME_COUNT)
+#define QUAD_COUNT (FIRST_PHASE_QUAD + 2 * OVERLAY_PHASE_COUNT)
+
+static const char* phaseNames[OVERLAY_PHASE_COUNT] = { "simulate", "prepare", "draw", "display" };
+// Share of the frame budget each phase may use, display also waits for the next frame
+static const float phaseShares[OVERLAY_PHASE_COUNT] = { 0.1f, 0.1f, 0.4f, 1.f };
+
+static void SetQuad(sfVertexArray* _vertices, int _quad, sfFloatRect _rect, sfColor _color)
+{
+	sfVector2f corners[4] =
+	{
+		{ _rect.left, _rect.top },
+		{ _rect.left + _rect.width, _rect.top },
+		{ _rect.left + _rect.width, _rect.top + _rect.height },
+		{ _rect.left, _rect.top + _rect.height },
+	};
+	for (int i = 0; i < 4; i++)
+	{
+		sfVertex* vertex = sfVertexArray_getVertex(_vertices, _quad * 4 + i);
+		vertex->position = corners[i];
+		vertex->color = _color;
+	}
+}
+
+static sfColor BudgetColor(float _time, float _budget)
+{
+	if (_time <= _budget)
+	{
+		return sfColor_fromRGB(80, 200, 80);
+	}
+	return _time <= 2 * _budget ? sfColor_fromRGB(230, 200, 60) : sfColor_fromRGB(230, 60, 60);
+}
+
+static int CompareFloat(const void* _a, const void* _b)
+{
+	float a = *(const float*)_a;
+	float b = *(const float*)_b;
+	return (a > b) - (a < b);
+}
+
+static void FormatText(Overlay* const _overlay)
+{
+	float sorted[OVERLAY_FRAME_COUNT];
+	int count = _overlay->frameCount;
+	float sum = 0;
+	for (int i = 0; i < count; i++)
+	{
+		sorted[i] = _overlay->frameTimes[i];
+		sum += sorted[i];
+	}
+	qsort(sorted, count, sizeof(float), CompareFloat);
+	int p99 = count ? (count * 99 + 99) / 100 - 1 : 0;
+
+	char buffer[512];
+	int length = snprintf(buffer, sizeof(buffer), "frame ms  min %.1f  avg %.1f  p99 %.1f\ndraws %d  texture switches %d  textures %.1f MiB",
+		count ? sorted[0] * 1000 : 0, count ? sum / count * 1000 : 0, count ? sorted[p99] * 1000 : 0,
+		_overlay->drawCount, _overlay->textureSwitchCount, _overlay->textureBytes / (1024.0 * 1024.0));
+	for (int phase = 0; phase < OVERLAY_PHASE_COUNT && length < (int)sizeof(buffer); phase++)
+	{
+		length += snprintf(buffer + length, sizeof(buffer) - length, "\n%s  %.2f / %.1f ms", phaseNames[phase],
+			_overlay->phaseTimes[phase] * 1000, _overlay->phaseBudgets[phase] * 1000);
+	}
+	sfText_setString(_overlay->text, buffer);
+}
+
+bool OverlayCreate(Overlay* const _overlay, const sfFont* _font, sfVector2f _position, float _frameBudget)
+{
+	*_overlay = (Overlay){ 0 };
+	_overlay->position = _position;
+	_overlay->frameBudget = _frameBudget;
+	for (int phase = 0; phase < OVERLAY_PHASE_COUNT; phase++)
+	{
+		_overlay->phaseBudgets[phase] = _frameBudget * phaseShares[phase];
+	}
+
+	_overlay->vertices = sfVertexArray_create();
+	_overlay->text = TRACK_CREATE(TRACK_TEXT, sfText_create());
+	if (!_overlay->vertices || !_overlay->text)
+	{
+		OverlayDestroy(_overlay);
+		return false;
+	}
+	sfVertexArray_setPrimitiveType(_overlay->vertices, sfQuads);
+	sfVertexArray_resize(_overlay->vertices, QUAD_COUNT * 4);
+	sfText_setFont(_overlay->text, _font);
+	sfText_setCharacterSize(_overlay->text, OVERLAY_CHARACTER_SIZE);
+	sfText_setPosition(_overlay->text, (sfVector2f) { _position.x + MARGIN, _position.y + MARGIN * 2 + OVERLAY_GRAPH_HEIGHT });
+
+	// Everything but the bars stays where it is
+	float lineSpacing = sfFont_getLineSpacing(_font, OVERLAY_CHARACTER_SIZE);
+	sfFloatRect panel = { _position.x, _position.y, OVERLAY_FRAME_COUNT + MARGIN * 2,
+		OVERLAY_GRAPH_HEIGHT + MARGIN * 4 + lineSpacing * LINE_COUNT };
+	SetQuad(_overlay->vertices, 0, panel, sfColor_fromRGBA(0, 0, 0, 160));
+	float budgetY = _position.y + MARGIN + OVERLAY_GRAPH_HEIGHT / 2;
+	SetQuad(_overlay->vertices, 1, (sfFloatRect) { _position.x + MARGIN, budgetY, OVERLAY_FRAME_COUNT, 1 }, sfColor_fromRGBA(255, 255, 255, 120));
+	for (int phase = 0; phase < OVERLAY_PHASE_COUNT; phase++)
+	{
+		float y = _position.y + MARGIN * 2 + OVERLAY_GRAPH_HEIGHT + lineSpacing * (2 + phase) + lineSpacing * 0.25f;
+		SetQuad(_overlay->vertices, FIRST_PHASE_QUAD + phase * 2,
+			(sfFloatRect) { _position.x + MARGIN + BAR_OFFSET, y, BAR_WIDTH, lineSpacing * 0.5f }, sfColor_fromRGBA(255, 255, 255, 60));
+	}
+	FormatText(_overlay);
+	return true;
+}
+
+void OverlayDestroy(Overlay* const _overlay)
+{
+	if (_overlay->vertices)
+	{
+		sfVertexArray_destroy(_overlay->vertices);
+		_overlay->vertices = NULL;
+	}
+	if (_overlay->text)
+	{
+		TRACK_DESTROY(TRACK_TEXT, sfText_destroy, _overlay->text);
+		_overlay->text = NULL;
+	}
+}
+
+void OverlayAddFrame(Overlay* const _overlay, float _dt, const float _phaseTimes[OVERLAY_PHASE_COUNT], int _drawCount, int _textureSwitchCount)
+{
+	_overlay->frameTimes[_overlay->frameHead] = _dt;
+	_overlay->frameHead = (_overlay->frameHead + 1) % OVERLAY_FRAME_COUNT;
+	if (_overlay->frameCount < OVERLAY_FRAME_COUNT)
+	{
+		_overlay->frameCount++;
+	}
+	for (int phase = 0; phase < OVERLAY_PHASE_COUNT; phase++)
+	{
+		_overlay->phaseTimes[phase] += (_phaseTimes[phase] - _overlay->phaseTimes[phase]) * PHASE_SMOOTHING;
+	}
+	_overlay->drawCount = _drawCount;
+	_overlay->textureSwitchCount = _textureSwitchCount;
+}
+
+void OverlayUpdate(Overlay* const _overlay, float _dt)
+{
+	// Oldest frame on the left, one pixel per frame
+	float bottom = _overlay->position.y + MARGIN + OVERLAY_GRAPH_HEIGHT;
+	float scale = OVERLAY_GRAPH_HEIGHT / (2 * _overlay->frameBudget);
+	for (int i = 0; i < OVERLAY_FRAME_COUNT; i++)
+	{
+		int age = OVERLAY_FRAME_COUNT - i;
+		float time = age <= _overlay->frameCount ? _overlay->frameTimes[(_overlay->frameHead - age + OVERLAY_FRAME_COUNT) % OVERLAY_FRAME_COUNT] : 0;
+		float height = time * scale < OVERLAY_GRAPH_HEIGHT ? time * scale : OVERLAY_GRAPH_HEIGHT;
+		SetQuad(_overlay->vertices, FIRST_FRAME_QUAD + i, (sfFloatRect) { _overlay->position.x + MARGIN + i, bottom - height, 1, height },
+			BudgetColor(time, _overlay->frameBudget));
+	}
+
+	for (int phase = 0; phase < OVERLAY_PHASE_COUNT; phase++)
+	{
+		sfVertex* background = sfVertexArray_getVertex(_overlay->vertices, (FIRST_PHASE_QUAD + phase * 2) * 4);
+		float time = _overlay->phaseTimes[phase];
+		float budget = _overlay->phaseBudgets[phase];
+		float fraction = time / budget < BAR_LIMIT ? time / budget : BAR_LIMIT;
+		SetQuad(_overlay->vertices, FIRST_PHASE_QUAD + phase * 2 + 1,
+			(sfFloatRect) { background[0].position.x, background[0].position.y, BAR_WIDTH * fraction, background[2].position.y - background[0].position.y },
+			BudgetColor(time, budget));
+	}
+
+	_overlay->textTime -= _dt;
+	if (_overlay->textTime <= 0)
+	{
+		_overlay->textTime = OVERLAY_TEXT_PERIOD;
+		FormatText(_overlay);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <SFML/Graphics.h>
+
+// Debug performance overlay: a rolling frame-time graph, where the frame
+// time went, and what the renderer submitted. The graph and the phase bars
+// are one sfVertexArray rewritten in place every frame; the numbers are a
+// single sfText only reformatted a few times per second.
+
+#pragma region Define
+#define OVERLAY_FRAME_COUNT 240
+#define OVERLAY_TEXT_PERIOD 0.5f
+#define OVERLAY_GRAPH_HEIGHT 80.f
+#define OVERLAY_CHARACTER_SIZE 12
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum OverlayPhase
+{
+	// Simulation ticks, on the main thread
+	OVERLAY_SIMULATE,
+	// Render thread phases that move the sprites
+	OVERLAY_PREPARE,
+	OVERLAY_DRAW,
+	// Includes the frame rate limiter
+	OVERLAY_DISPLAY,
+	OVERLAY_PHASE_COUNT,
+}OverlayPhase;
+
+typedef struct Overlay
+{
+	float frameTimes[OVERLAY_FRAME_COUNT];
+	int frameHead;
+	int frameCount;
+	// Smoothed seconds per phase, and what each is allowed
+	float phaseTimes[OVERLAY_PHASE_COUNT];
+	float phaseBudgets[OVERLAY_PHASE_COUNT];
+	// Seconds per frame, the graph tops out at twice this
+	float frameBudget;
+	int drawCount;
+	int textureSwitchCount;
+	// Set by the owner, the texture memory of the loaded assets
+	size_t textureBytes;
+	float textTime;
+	sfVector2f position;
+	sfVertexArray* vertices;
+	sfText* text;
+}Overlay;
+#pragma endregion
+
+#pragma region Definition
+bool OverlayCreate(Overlay* const _overlay, const sfFont* _font, sfVector2f _position, float _frameBudget);
+void OverlayDestroy(Overlay* const _overlay);
+
+void OverlayAddFrame(Overlay* const _overlay, float _dt, const float _phaseTimes[OVERLAY_PHASE_COUNT], int _drawCount, int _textureSwitchCount);
+// Only needed on the frames the overlay is drawn
+void OverlayUpdate(Overlay* const _overlay, float _dt);
+#pragma endregion
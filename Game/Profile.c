@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Profile.h"
+#include "Atomic.h"
+#include "File.h"
+#include "Thread.h"
+#include "Timer.h"
+
+static ProfileThread* volatile threads[PROFILE_MAX_THREADS];
+static volatile int32_t threadCount;
+static volatile int32_t isRunning;
+static volatile int64_t startTime;
+static THREAD_LOCAL ProfileThread* current;
+// Set when the registry was full, the thread then records nothing
+static THREAD_LOCAL bool isUntracked;
+
+static ProfileThread* Register(const char* _name)
+{
+	int32_t id = AtomicAdd32(&threadCount, 1) - 1;
+	ProfileThread* thread = id < PROFILE_MAX_THREADS ? calloc(1, sizeof(ProfileThread)) : NULL;
+	if (!thread)
+	{
+		isUntracked = true;
+		return NULL;
+	}
+	thread->id = id;
+	if (_name)
+	{
+		snprintf(thread->name, sizeof(thread->name), "%s", _name);
+	}
+	else
+	{
+		snprintf(thread->name, sizeof(thread->name), "thread %d", id);
+	}
+	AtomicStorePointer((void* volatile*)&threads[id], thread);
+	current = thread;
+	return thread;
+}
+
+static ProfileThread* CurrentThread(void)
+{
+	if (current || isUntracked)
+	{
+		return current;
+	}
+	return Register(NULL);
+}
+
+void ProfileSetThreadName(const char* _name)
+{
+	if (current)
+	{
+		snprintf(current->name, sizeof(current->name), "%s", _name);
+	}
+	else if (!isUntracked)
+	{
+		Register(_name);
+	}
+}
+
+void ProfileStart(void)
+{
+	AtomicStore64(&startTime, TimerTicks());
+	AtomicStore32(&isRunning, 1);
+}
+
+void ProfileStop(void)
+{
+	AtomicStore32(&isRunning, 0);
+}
+
+bool ProfileIsRunning(void)
+{
+	return AtomicLoad32(&isRunning) != 0;
+}
+
+int64_t ProfileBegin(void)
+{
+	return AtomicLoad32(&isRunning) ? TimerTicks() : 0;
+}
+
+void ProfileEnd(const char* _name, int64_t _begin)
+{
+	// Also skips the scopes that were opened before the capture started
+	if (!_begin)
+	{
+		return;
+	}
+
+	ProfileThread* thread = CurrentThread();
+	if (thread)
+	{
+		int32_t head = thread->head;
+		thread->events[head & (PROFILE_RING_SIZE - 1)] = (ProfileEvent){ _name, _begin, TimerTicks() };
+		AtomicStore32(&thread->head, head + 1);
+	}
+}
+
+bool ProfileWriteTrace(const char* _path)
+{
+	FILE* file = FileOpen(_path, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	int64_t start = AtomicLoad64(&startTime);
+	double toMicro = 1000000.0 / TimerFrequency();
+	int count = AtomicLoad32(&threadCount);
+	count = count < PROFILE_MAX_THREADS ? count : PROFILE_MAX_THREADS;
+	bool isFirst = true;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (int i = 0; i < count; i++)
+	{
+		ProfileThread* thread = AtomicLoadPointer((void* volatile*)&threads[i]);
+		if (!thread)
+		{
+			continue;
+		}
+		fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+			isFirst ? "" : ",", thread->id, thread->name);
+		isFirst = false;
+
+		// Scopes still open when the capture stopped may write past the newest slot,
+		// over the oldest ones once the ring has wrapped
+		int32_t head = AtomicLoad32(&thread->head);
+		int32_t first = head > PROFILE_RING_SIZE - PROFILE_RING_GUARD ? head - (PROFILE_RING_SIZE - PROFILE_RING_GUARD) : 0;
+		for (int32_t e = first; e < head; e++)
+		{
+			const ProfileEvent* event = &thread->events[e & (PROFILE_RING_SIZE - 1)];
+			if (event->begin < start)
+			{
+				continue;
+			}
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				event->name, thread->id, (event->begin - start) * toMicro, (event->end - event->begin) * toMicro);
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	bool isWritten = !ferror(file);
+	fclose(file);
+	return isWritten;
+}
+
+void ProfileShutdown(void)
+{
+	int count = AtomicLoad32(&threadCount);
+	count = count < PROFILE_MAX_THREADS ? count : PROFILE_MAX_THREADS;
+	for (int i = 0; i < count; i++)
+	{
+		free(threads[i]);
+		threads[i] = NULL;
+	}
+	AtomicStore32(&threadCount, 0);
+	current = NULL;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Scoped timers written to a ring per thread, dumped as a Chrome/Perfetto
+// trace (chrome://tracing, ui.perfetto.dev). While no capture is running a
+// scope costs one load and one branch; build with PROFILE_ENABLED 0 to
+// remove the scopes entirely.
+
+#pragma region Define
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 1
+#endif
+
+// Power of two, the oldest scopes are overwritten
+#define PROFILE_RING_SIZE 16384
+// Deepest scope nesting, see ProfileWriteTrace
+#define PROFILE_RING_GUARD 64
+#define PROFILE_MAX_THREADS 32
+
+#if PROFILE_ENABLED
+#define PROFILE_BEGIN(_name) int64_t profile##_name = ProfileBegin()
+#define PROFILE_END(_name) ProfileEnd(#_name, profile##_name)
+#else
+#define PROFILE_BEGIN(_name)
+#define PROFILE_END(_name)
+#endif
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct ProfileEvent
+{
+	// Must outlive the capture, scope names are string literals
+	const char* name;
+	int64_t begin;
+	int64_t end;
+}ProfileEvent;
+
+typedef struct ProfileThread
+{
+	ProfileEvent events[PROFILE_RING_SIZE];
+	// Only written by the owning thread
+	volatile int32_t head;
+	int id;
+	char name[32];
+}ProfileThread;
+#pragma endregion
+
+#pragma region Definition
+// Call first thing in the thread, threads that never call it show up as "thread <id>"
+void ProfileSetThreadName(const char* _name);
+
+// Starting a capture drops whatever an earlier one recorded
+void ProfileStart(void);
+void ProfileStop(void);
+bool ProfileIsRunning(void);
+
+// 0 while no capture runs
+int64_t ProfileBegin(void);
+void ProfileEnd(const char* _name, int64_t _begin);
+
+// Call once no thread records anymore, or stop the capture first
+bool ProfileWriteTrace(const char* _path);
+void ProfileShutdown(void);
+#pragma endregion
@@ -0,0 +1,77 @@
+#include "Random.h"
+
+static uint32_t Rotl(uint32_t _value, int _count)
+{
+	return (_value << _count) | (_value >> (32 - _count));
+}
+
+static uint64_t SplitMix64(uint64_t* const _state)
+{
+	uint64_t z = (*_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+void RandomSeed(Random* const _random, uint64_t _seed)
+{
+	// SplitMix64 spreads close seeds (0, 1, 2...) over the whole state
+	uint64_t a = SplitMix64(&_seed);
+	uint64_t b = SplitMix64(&_seed);
+	_random->state[0] = (uint32_t)a;
+	_random->state[1] = (uint32_t)(a >> 32);
+	_random->state[2] = (uint32_t)b;
+	_random->state[3] = (uint32_t)(b >> 32);
+}
+
+void RandomJump(Random* const _random)
+{
+	// Equivalent to 2^64 calls to RandomNext: used to split one seed into non-overlapping streams
+	static const uint32_t jump[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+
+	uint32_t s0 = 0;
+	uint32_t s1 = 0;
+	uint32_t s2 = 0;
+	uint32_t s3 = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int b = 0; b < 32; b++)
+		{
+			if (jump[i] & (UINT32_C(1) << b))
+			{
+				s0 ^= _random->state[0];
+				s1 ^= _random->state[1];
+				s2 ^= _random->state[2];
+				s3 ^= _random->state[3];
+			}
+			RandomNext(_random);
+		}
+	}
+
+	_random->state[0] = s0;
+	_random->state[1] = s1;
+	_random->state[2] = s2;
+	_random->state[3] = s3;
+}
+
+uint32_t RandomNext(Random* const _random)
+{
+	uint32_t* s = _random->state;
+	uint32_t result = Rotl(s[1] * 5, 7) * 9;
+	uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = Rotl(s[3], 11);
+
+	return result;
+}
+
+float RandomFloat(Random* const _random)
+{
+	// 24 bits is all a float mantissa can hold
+	return (RandomNext(_random) >> 8) * (1.f / 16777216.f);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// xoshiro128** generator: 128 bits of state, no global state, so every
+// game (or thread) owns its own independent and reproducible sequence.
+
+#pragma region Struct and Enum
+typedef struct Random
+{
+	uint32_t state[4];
+}Random;
+#pragma endregion
+
+#pragma region Definition
+void RandomSeed(Random* const _random, uint64_t _seed);
+void RandomJump(Random* const _random);
+uint32_t RandomNext(Random* const _random);
+// Uniform in [0, 1)
+float RandomFloat(Random* const _random);
+#pragma endregion
@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include <string.h>
+#include "File.h"
+#include "Replay.h"
+
+#pragma region Definition
+static void WriteVarint(FILE* _file, uint64_t _value);
+static bool ReadVarint(FILE* _file, uint64_t* const _value);
+#pragma endregion
+
+void ReplayBegin(Replay* const _replay, uint64_t _seed, int _height, int _tickRate)
+{
+	_replay->seed = _seed;
+	_replay->height = _height;
+	_replay->tickRate = _tickRate;
+	_replay->endTick = 0;
+	_replay->eventCount = 0;
+}
+
+bool ReplayRecord(Replay* const _replay, uint32_t _tick, ReplayEventType _type)
+{
+	if (_replay->eventCount == _replay->eventCapacity)
+	{
+		size_t capacity = _replay->eventCapacity ? _replay->eventCapacity * 2 : 256;
+		ReplayEvent* events = realloc(_replay->events, capacity * sizeof(ReplayEvent));
+		if (!events)
+		{
+			return false;
+		}
+		_replay->events = events;
+		_replay->eventCapacity = capacity;
+	}
+
+	_replay->events[_replay->eventCount].tick = _tick;
+	_replay->events[_replay->eventCount].type = _type;
+	_replay->eventCount++;
+	return true;
+}
+
+void ReplayFree(Replay* const _replay)
+{
+	free(_replay->events);
+	_replay->events = NULL;
+	_replay->eventCount = 0;
+	_replay->eventCapacity = 0;
+}
+
+bool ReplaySave(Replay* const _replay, const char* _path, uint32_t _endTick)
+{
+	FILE* file = FileOpen(_path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	_replay->endTick = _endTick;
+	fwrite(REPLAY_MAGIC, 1, 4, file);
+	fputc(REPLAY_VERSION, file);
+	fputc(_replay->height, file);
+	WriteVarint(file, _replay->tickRate);
+	for (int i = 0; i < 8; i++)
+	{
+		fputc((int)((_replay->seed >> (i * 8)) & 0xFF), file);
+	}
+	WriteVarint(file, _replay->endTick);
+	WriteVarint(file, _replay->eventCount);
+
+	// Events are sorted by tick, so deltas stay small: most chops fit in one byte
+	uint32_t previousTick = 0;
+	for (size_t i = 0; i < _replay->eventCount; i++)
+	{
+		const ReplayEvent* event = &_replay->events[i];
+		WriteVarint(file, ((uint64_t)(event->tick - previousTick) << 2) | event->type);
+		previousTick = event->tick;
+	}
+
+	bool isWritten = !ferror(file);
+	fclose(file);
+	return isWritten;
+}
+
+bool ReplayLoad(Replay* const _replay, const char* _path)
+{
+	FILE* file = FileOpen(_path, "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	char magic[4];
+	uint64_t tickRate = 0;
+	uint64_t endTick = 0;
+	uint64_t eventCount = 0;
+	bool isValid = fread(magic, 1, 4, file) == 4 && memcmp(magic, REPLAY_MAGIC, 4) == 0
+		&& fgetc(file) == REPLAY_VERSION;
+
+	int height = isValid ? fgetc(file) : EOF;
+	isValid = isValid && height != EOF && ReadVarint(file, &tickRate) && tickRate > 0;
+
+	uint64_t seed = 0;
+	for (int i = 0; i < 8 && isValid; i++)
+	{
+		int byte = fgetc(file);
+		isValid = byte != EOF;
+		seed |= (uint64_t)(byte & 0xFF) << (i * 8);
+	}
+	isValid = isValid && ReadVarint(file, &endTick) && ReadVarint(file, &eventCount);
+
+	if (isValid)
+	{
+		ReplayBegin(_replay, seed, height, (int)tickRate);
+		_replay->endTick = (uint32_t)endTick;
+
+		uint32_t tick = 0;
+		for (uint64_t i = 0; i < eventCount && isValid; i++)
+		{
+			uint64_t value = 0;
+			isValid = ReadVarint(file, &value) && (value & 3) <= REPLAY_CHOP_RIGHT;
+			tick += (uint32_t)(value >> 2);
+			isValid = isValid && ReplayRecord(_replay, tick, (ReplayEventType)(value & 3));
+		}
+	}
+
+	fclose(file);
+	return isValid;
+}
+
+void ReplayPlayerStart(ReplayPlayer* const _player, const Replay* const _replay, Simulation* const _sim)
+{
+	_player->replay = _replay;
+	_player->cursor = 0;
+	SimSeed(_sim, _replay->seed, 0);
+	SimReset(_sim, _replay->height);
+}
+
+SimAction ReplayPlayerTick(ReplayPlayer* const _player, Simulation* const _sim)
+{
+	SimAction action = SIM_NONE;
+	const Replay* replay = _player->replay;
+	while (_player->cursor < replay->eventCount && replay->events[_player->cursor].tick == _sim->tick)
+	{
+		switch (replay->events[_player->cursor].type)
+		{
+		case REPLAY_START:
+			SimStart(_sim);
+			break;
+		case REPLAY_CHOP_LEFT:
+			action = SIM_CHOP_LEFT;
+			break;
+		case REPLAY_CHOP_RIGHT:
+			action = SIM_CHOP_RIGHT;
+			break;
+		default:
+			break;
+		}
+		_player->cursor++;
+	}
+	return action;
+}
+
+bool ReplayPlayerIsFinished(const ReplayPlayer* const _player, const Simulation* const _sim)
+{
+	if (_sim->dead)
+	{
+		return true;
+	}
+	return _player->cursor == _player->replay->eventCount && _sim->tick >= _player->replay->endTick;
+}
+
+static void WriteVarint(FILE* _file, uint64_t _value)
+{
+	while (_value >= 0x80)
+	{
+		fputc((int)(_value & 0x7F) | 0x80, _file);
+		_value >>= 7;
+	}
+	fputc((int)_value, _file);
+}
+
+static bool ReadVarint(FILE* _file, uint64_t* const _value)
+{
+	*_value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		int byte = fgetc(_file);
+		if (byte == EOF)
+		{
+			return false;
+		}
+		*_value |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
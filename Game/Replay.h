@@ -0,0 +1,59 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Simulation.h"
+
+// Session recording: the seed plus every event that reached the simulation.
+// On disk each event is one varint holding (tick delta << 2 | type).
+
+#pragma region Define
+#define REPLAY_MAGIC "TMRP"
+#define REPLAY_VERSION 1
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum ReplayEventType
+{
+	REPLAY_START,
+	REPLAY_CHOP_LEFT,
+	REPLAY_CHOP_RIGHT,
+}ReplayEventType;
+
+typedef struct ReplayEvent
+{
+	// Value of Simulation.tick before the SimStep the event applies to
+	uint32_t tick;
+	ReplayEventType type;
+}ReplayEvent;
+
+typedef struct Replay
+{
+	uint64_t seed;
+	int height;
+	int tickRate;
+	uint32_t endTick;
+	ReplayEvent* events;
+	size_t eventCount;
+	size_t eventCapacity;
+}Replay;
+
+typedef struct ReplayPlayer
+{
+	const Replay* replay;
+	size_t cursor;
+}ReplayPlayer;
+#pragma endregion
+
+#pragma region Definition
+void ReplayBegin(Replay* const _replay, uint64_t _seed, int _height, int _tickRate);
+bool ReplayRecord(Replay* const _replay, uint32_t _tick, ReplayEventType _type);
+void ReplayFree(Replay* const _replay);
+
+bool ReplaySave(Replay* const _replay, const char* _path, uint32_t _endTick);
+bool ReplayLoad(Replay* const _replay, const char* _path);
+
+void ReplayPlayerStart(ReplayPlayer* const _player, const Replay* const _replay, Simulation* const _sim);
+SimAction ReplayPlayerTick(ReplayPlayer* const _player, Simulation* const _sim);
+bool ReplayPlayerIsFinished(const ReplayPlayer* const _player, const Simulation* const _sim);
+#pragma endregion
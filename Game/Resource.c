@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+#include "Track.h"
+#include "Resource.h"
+
+#pragma region Definition
+static Resource* Acquire(ResourceCache* const _cache, const char* _name, ResourceKind _kind);
+static void* Create(ResourceCache* const _cache, const char* _name, ResourceKind _kind, size_t* const _size);
+static void* Decode(const void* _data, size_t _size, ResourceKind _kind);
+static void Destroy(Resource* const _resource);
+#pragma endregion
+
+// What the loader decodes each kind into
+static const LoadKind loadKinds[] = { LOAD_IMAGE, LOAD_FONT, LOAD_SOUND, LOAD_DATA };
+// The data is not an object, it is never tracked
+static const TrackType trackTypes[] = { TRACK_TEXTURE, TRACK_FONT, TRACK_SOUND_BUFFER };
+
+void ResourceCacheCreate(ResourceCache* const _cache, const AssetPack* const _pack)
+{
+	*_cache = (ResourceCache){ 0 };
+	_cache->pack = _pack;
+}
+
+void ResourceCacheDestroy(ResourceCache* const _cache)
+{
+	for (int i = 0; i < _cache->count; i++)
+	{
+		Destroy(&_cache->resources[i]);
+	}
+	*_cache = (ResourceCache){ 0 };
+}
+
+void ResourceCacheSetLoader(ResourceCache* const _cache, Loader* const _loader)
+{
+	_cache->loader = _loader;
+}
+
+sfTexture* ResourceGetTexture(ResourceCache* const _cache, const char* _name)
+{
+	Resource* resource = Acquire(_cache, _name, RESOURCE_TEXTURE);
+	return resource ? resource->object : NULL;
+}
+
+sfFont* ResourceGetFont(ResourceCache* const _cache, const char* _name)
+{
+	Resource* resource = Acquire(_cache, _name, RESOURCE_FONT);
+	return resource ? resource->object : NULL;
+}
+
+sfSoundBuffer* ResourceGetSoundBuffer(ResourceCache* const _cache, const char* _name)
+{
+	Resource* resource = Acquire(_cache, _name, RESOURCE_SOUND_BUFFER);
+	return resource ? resource->object : NULL;
+}
+
+const void* ResourceGetData(ResourceCache* const _cache, const char* _name, size_t* const _size)
+{
+	Resource* resource = Acquire(_cache, _name, RESOURCE_DATA);
+	if (_size)
+	{
+		*_size = resource ? resource->size : 0;
+	}
+	return resource ? resource->object : NULL;
+}
+
+void ResourceRelease(ResourceCache* const _cache, const void* _object)
+{
+	if (!_object)
+	{
+		return;
+	}
+	for (int i = 0; i < _cache->count; i++)
+	{
+		Resource* resource = &_cache->resources[i];
+		if (resource->object == _object)
+		{
+			if (--resource->refCount == 0)
+			{
+				_cache->textureBytes -= resource->bytes;
+				Destroy(resource);
+				// Nothing outside points into the array, the last one fills the hole
+				*resource = _cache->resources[--_cache->count];
+			}
+			return;
+		}
+	}
+}
+
+size_t ResourceCacheTextureBytes(const ResourceCache* const _cache)
+{
+	return _cache->textureBytes;
+}
+
+static Resource* Acquire(ResourceCache* const _cache, const char* _name, ResourceKind _kind)
+{
+	for (int i = 0; i < _cache->count; i++)
+	{
+		Resource* resource = &_cache->resources[i];
+		if (strcmp(resource->name, _name) == 0)
+		{
+			if (resource->kind != _kind)
+			{
+				return NULL;
+			}
+			resource->refCount++;
+			return resource;
+		}
+	}
+
+	size_t size = 0;
+	void* object = _cache->count < RESOURCE_MAX_COUNT ? Create(_cache, _name, _kind, &size) : NULL;
+	if (!object)
+	{
+		return NULL;
+	}
+	Resource* resource = &_cache->resources[_cache->count++];
+	*resource = (Resource){ 0 };
+	snprintf(resource->name, sizeof(resource->name), "%s", _name);
+	resource->kind = _kind;
+	resource->object = object;
+	resource->size = size;
+	resource->refCount = 1;
+	if (_kind == RESOURCE_TEXTURE)
+	{
+		sfVector2u textureSize = sfTexture_getSize(object);
+		resource->bytes = (size_t)textureSize.x * textureSize.y * 4;
+		_cache->textureBytes += resource->bytes;
+	}
+	return resource;
+}
+
+static void* Create(ResourceCache* const _cache, const char* _name, ResourceKind _kind, size_t* const _size)
+{
+	const LoadTask* task = _cache->loader ? LoaderFind(_cache->loader, _name) : NULL;
+	if (!task || task->kind != loadKinds[_kind])
+	{
+		const void* data = AssetPackGet(_cache->pack, _name, _size);
+		return data ? Decode(data, *_size, _kind) : NULL;
+	}
+
+	*_size = task->size;
+	void* result = LoaderTake(_cache->loader, _name);
+	if (_kind == RESOURCE_DATA || !result)
+	{
+		return result;
+	}
+	if (_kind != RESOURCE_TEXTURE)
+	{
+		// Ours from now on, the loader no longer destroys it
+		return TRACK_CREATE(trackTypes[_kind], result);
+	}
+	// The workers only decode the image, the upload needs the context of this thread
+	sfTexture* texture = TRACK_CREATE(TRACK_TEXTURE, sfTexture_createFromImage(result, NULL));
+	sfImage_destroy(result);
+	return texture;
+}
+
+static void* Decode(const void* _data, size_t _size, ResourceKind _kind)
+{
+	switch (_kind)
+	{
+	case RESOURCE_TEXTURE:
+		return TRACK_CREATE(TRACK_TEXTURE, sfTexture_createFromMemory(_data, _size, NULL));
+	case RESOURCE_FONT:
+		return TRACK_CREATE(TRACK_FONT, sfFont_createFromMemory(_data, _size));
+	case RESOURCE_SOUND_BUFFER:
+		return TRACK_CREATE(TRACK_SOUND_BUFFER, sfSoundBuffer_createFromMemory(_data, _size));
+	case RESOURCE_DATA:
+		return (void*)_data;
+	}
+	return NULL;
+}
+
+static void Destroy(Resource* const _resource)
+{
+	switch (_resource->kind)
+	{
+	case RESOURCE_TEXTURE:
+		TRACK_DESTROY(TRACK_TEXTURE, sfTexture_destroy, _resource->object);
+		break;
+	case RESOURCE_FONT:
+		TRACK_DESTROY(TRACK_FONT, sfFont_destroy, _resource->object);
+		break;
+	case RESOURCE_SOUND_BUFFER:
+		TRACK_DESTROY(TRACK_SOUND_BUFFER, sfSoundBuffer_destroy, _resource->object);
+		break;
+	case RESOURCE_DATA:
+		break;
+	}
+	_resource->object = NULL;
+}
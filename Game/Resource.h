@@ -0,0 +1,70 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <SFML/Graphics.h>
+#include <SFML/Audio.h>
+#include "AssetPack.h"
+#include "Loader.h"
+
+// Shared resources keyed by their pack entry name: every texture, font and
+// sound buffer is created once, every user gets the same object and holds a
+// reference to it, and the object is destroyed as soon as the last reference
+// is released. Main thread only, textures are created and destroyed with the
+// OpenGL context.
+
+#pragma region Define
+#define RESOURCE_MAX_COUNT 32
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum ResourceKind
+{
+	RESOURCE_TEXTURE,
+	RESOURCE_FONT,
+	RESOURCE_SOUND_BUFFER,
+	// The checked entry itself, it stays in the pack mapping
+	RESOURCE_DATA,
+}ResourceKind;
+
+typedef struct Resource
+{
+	char name[ASSET_PACK_NAME_LENGTH];
+	ResourceKind kind;
+	void* object;
+	size_t size;
+	int refCount;
+	// Texture memory, 0 for the other kinds
+	size_t bytes;
+}Resource;
+
+typedef struct ResourceCache
+{
+	const AssetPack* pack;
+	// While loading: what it already decoded is taken over rather than decoded again
+	Loader* loader;
+	// Only the referenced ones, a resource leaves the array with its last reference
+	Resource resources[RESOURCE_MAX_COUNT];
+	int count;
+	size_t textureBytes;
+}ResourceCache;
+#pragma endregion
+
+#pragma region Definition
+// The pack must stay open as long as the cache, fonts and data read from it
+void ResourceCacheCreate(ResourceCache* const _cache, const AssetPack* const _pack);
+// Destroys whatever is still referenced: every resource left in the cache is a missing release
+void ResourceCacheDestroy(ResourceCache* const _cache);
+// NULL once the loader is destroyed, the entries it did not decode are decoded here on demand
+void ResourceCacheSetLoader(ResourceCache* const _cache, Loader* const _loader);
+
+// One more reference per successful call, NULL if the entry is missing, corrupt, undecodable or of another kind
+sfTexture* ResourceGetTexture(ResourceCache* const _cache, const char* _name);
+sfFont* ResourceGetFont(ResourceCache* const _cache, const char* _name);
+sfSoundBuffer* ResourceGetSoundBuffer(ResourceCache* const _cache, const char* _name);
+const void* ResourceGetData(ResourceCache* const _cache, const char* _name, size_t* const _size);
+// Drops one reference to what a ResourceGet returned, the last one destroys it. NULL is ignored.
+void ResourceRelease(ResourceCache* const _cache, const void* _object);
+
+// Bytes of every live texture, at 4 bytes per pixel
+size_t ResourceCacheTextureBytes(const ResourceCache* const _cache);
+#pragma endregion
@@ -0,0 +1,593 @@
+#include <stdlib.h>
+#include <string.h>
+#include "SimBatch.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIM_BATCH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define SIM_BATCH_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+#pragma region Definition
+static void* AllocLanes(int _capacity, size_t _laneSize);
+static void FreeLanes(void* _lanes);
+
+static void StepScalar(SimBatch* const _batch, float _dt);
+#if SIM_BATCH_X86
+static void StepSse2(SimBatch* const _batch, float _dt);
+static void StepAvx2(SimBatch* const _batch, float _dt);
+#endif
+#pragma endregion
+
+bool SimBatchCreate(SimBatch* const _batch, int _count, int _height, uint64_t _seed)
+{
+	memset(_batch, 0, sizeof(*_batch));
+	if (_count < 1)
+	{
+		return false;
+	}
+
+	if (_height < 1)
+	{
+		_height = 1;
+	}
+	else if (_height > MAX_TRUNC_COUNT)
+	{
+		_height = MAX_TRUNC_COUNT;
+	}
+
+	// Padding lanes are kept dead so the SIMD paths never need a scalar tail
+	_batch->count = _count;
+	_batch->capacity = (_count + SIM_BATCH_WIDTH - 1) / SIM_BATCH_WIDTH * SIM_BATCH_WIDTH;
+	_batch->height = _height;
+	_batch->path = SimBatchDetectPath();
+
+	_batch->lifeTime = AllocLanes(_batch->capacity, sizeof(float));
+	_batch->score = AllocLanes(_batch->capacity, sizeof(int32_t));
+	_batch->dir = AllocLanes(_batch->capacity, sizeof(int32_t));
+	_batch->dead = AllocLanes(_batch->capacity, sizeof(int32_t));
+	_batch->isStarted = AllocLanes(_batch->capacity, sizeof(int32_t));
+	_batch->action = AllocLanes(_batch->capacity, sizeof(int32_t));
+	for (int i = 0; i < 4; i++)
+	{
+		_batch->random[i] = AllocLanes(_batch->capacity, sizeof(uint32_t));
+	}
+	_batch->branchLeft = AllocLanes(_batch->capacity, sizeof(uint64_t));
+	_batch->branchRight = AllocLanes(_batch->capacity, sizeof(uint64_t));
+	_batch->bark = AllocLanes(_batch->capacity, sizeof(uint64_t));
+
+	if (!_batch->lifeTime || !_batch->score || !_batch->dir || !_batch->dead || !_batch->isStarted
+		|| !_batch->action || !_batch->random[0] || !_batch->random[1] || !_batch->random[2] || !_batch->random[3]
+		|| !_batch->branchLeft || !_batch->branchRight || !_batch->bark)
+	{
+		SimBatchDestroy(_batch);
+		return false;
+	}
+
+	// Game i gets stream i of the seed, the same sequence SimSeed(sim, seed, i) gives
+	Random random;
+	RandomSeed(&random, _seed);
+	for (int i = 0; i < _batch->capacity; i++)
+	{
+		if (i < _count)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				_batch->random[k][i] = random.state[k];
+			}
+			RandomJump(&random);
+			SimBatchReset(_batch, i);
+		}
+		else
+		{
+			_batch->dead[i] = -1;
+		}
+	}
+	return true;
+}
+
+void SimBatchDestroy(SimBatch* const _batch)
+{
+	FreeLanes(_batch->lifeTime);
+	FreeLanes(_batch->score);
+	FreeLanes(_batch->dir);
+	FreeLanes(_batch->dead);
+	FreeLanes(_batch->isStarted);
+	FreeLanes(_batch->action);
+	for (int i = 0; i < 4; i++)
+	{
+		FreeLanes(_batch->random[i]);
+	}
+	FreeLanes(_batch->branchLeft);
+	FreeLanes(_batch->branchRight);
+	FreeLanes(_batch->bark);
+	memset(_batch, 0, sizeof(*_batch));
+}
+
+void SimBatchReset(SimBatch* const _batch, int _index)
+{
+	Simulation sim;
+	SimConfigDefault(&sim.config);
+	for (int k = 0; k < 4; k++)
+	{
+		sim.random.state[k] = _batch->random[k][_index];
+	}
+	SimReset(&sim, _batch->height);
+	for (int k = 0; k < 4; k++)
+	{
+		_batch->random[k][_index] = sim.random.state[k];
+	}
+
+	_batch->lifeTime[_index] = sim.lifeTime;
+	_batch->score[_index] = sim.score;
+	_batch->dir[_index] = sim.dir;
+	_batch->dead[_index] = 0;
+	_batch->isStarted[_index] = 0;
+	_batch->action[_index] = SIM_NONE;
+	_batch->branchLeft[_index] = sim.branchLeft;
+	_batch->branchRight[_index] = sim.branchRight;
+	_batch->bark[_index] = sim.bark;
+}
+
+void SimBatchStart(SimBatch* const _batch)
+{
+	for (int i = 0; i < _batch->count; i++)
+	{
+		_batch->isStarted[i] = -1;
+	}
+}
+
+void SimBatchStep(SimBatch* const _batch, float _dt)
+{
+	switch (_batch->path)
+	{
+#if SIM_BATCH_X86
+	case SIM_BATCH_AVX2:
+		StepAvx2(_batch, _dt);
+		break;
+	case SIM_BATCH_SSE2:
+		StepSse2(_batch, _dt);
+		break;
+#endif
+	default:
+		StepScalar(_batch, _dt);
+		break;
+	}
+}
+
+void SimBatchGet(const SimBatch* const _batch, int _index, Simulation* const _sim)
+{
+	_sim->branchLeft = _batch->branchLeft[_index];
+	_sim->branchRight = _batch->branchRight[_index];
+	_sim->bark = _batch->bark[_index];
+	_sim->height = _batch->height;
+	_sim->tick = 0;
+	_sim->lifeTime = _batch->lifeTime[_index];
+	_sim->score = _batch->score[_index];
+	_sim->dir = _batch->dir[_index];
+	_sim->dead = _batch->dead[_index] != 0;
+	_sim->isStarted = _batch->isStarted[_index] != 0;
+	for (int k = 0; k < 4; k++)
+	{
+		_sim->random.state[k] = _batch->random[k][_index];
+	}
+	SimConfigDefault(&_sim->config);
+}
+
+SimBatchPath SimBatchDetectPath(void)
+{
+#if SIM_BATCH_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	int hasSse2 = (info[3] >> 26) & 1;
+	int hasOsAvx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+	int hasAvx2 = 0;
+	if (maxLeaf >= 7 && hasOsAvx)
+	{
+		__cpuidex(info, 7, 0);
+		hasAvx2 = (info[1] >> 5) & 1;
+	}
+#else
+	__builtin_cpu_init();
+	int hasSse2 = __builtin_cpu_supports("sse2");
+	int hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+	if (hasAvx2)
+	{
+		return SIM_BATCH_AVX2;
+	}
+	if (hasSse2)
+	{
+		return SIM_BATCH_SSE2;
+	}
+#endif
+	return SIM_BATCH_SCALAR;
+}
+
+const char* SimBatchPathName(SimBatchPath _path)
+{
+	switch (_path)
+	{
+	case SIM_BATCH_SSE2:
+		return "sse2";
+	case SIM_BATCH_AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+static void* AllocLanes(int _capacity, size_t _laneSize)
+{
+	size_t size = (size_t)_capacity * _laneSize;
+#ifdef _MSC_VER
+	void* lanes = _aligned_malloc(size, 32);
+#else
+	void* lanes = aligned_alloc(32, size);
+#endif
+	if (lanes)
+	{
+		memset(lanes, 0, size);
+	}
+	return lanes;
+}
+
+static void FreeLanes(void* _lanes)
+{
+#ifdef _MSC_VER
+	_aligned_free(_lanes);
+#else
+	free(_lanes);
+#endif
+}
+
+#pragma region Scalar
+static void StepScalar(SimBatch* const _batch, float _dt)
+{
+	int top = _batch->height - 1;
+	for (int i = 0; i < _batch->capacity; i++)
+	{
+		if (_batch->action[i] != SIM_NONE && !_batch->dead[i])
+		{
+			_batch->dir[i] = _batch->action[i] == SIM_CHOP_LEFT ? -1 : 1;
+			uint64_t side = _batch->dir[i] == -1 ? _batch->branchLeft[i] : _batch->branchRight[i];
+			if (side & 1)
+			{
+				_batch->dead[i] = -1;
+			}
+			else
+			{
+				_batch->lifeTime[i] += LIFE_BONUS;
+				_batch->score[i]++;
+
+				// Same generation rule and draw as SimShiftTrunc
+				Random random;
+				for (int k = 0; k < 4; k++)
+				{
+					random.state[k] = _batch->random[k][i];
+				}
+				uint32_t value = RandomNext(&random);
+				for (int k = 0; k < 4; k++)
+				{
+					_batch->random[k][i] = random.state[k];
+				}
+
+				uint64_t topBranch = ((_batch->branchLeft[i] | _batch->branchRight[i]) >> top) & 1;
+				uint32_t truncType = topBranch ? value >> 31 : value >> 30;
+				uint64_t topBit = (uint64_t)1 << top;
+				_batch->branchLeft[i] = (_batch->branchLeft[i] >> 1) | (truncType == LEFT ? topBit : 0);
+				_batch->branchRight[i] = (_batch->branchRight[i] >> 1) | (truncType == RIGHT ? topBit : 0);
+				_batch->bark[i] = (_batch->bark[i] >> 1) | (truncType == NORMAL2 ? topBit : 0);
+
+				side = _batch->dir[i] == -1 ? _batch->branchLeft[i] : _batch->branchRight[i];
+				if (side & 1)
+				{
+					_batch->dead[i] = -1;
+				}
+			}
+		}
+
+		if (_batch->lifeTime[i] <= 0)
+		{
+			_batch->dead[i] = -1;
+		}
+
+		if (!_batch->dead[i])
+		{
+			if (_batch->isStarted[i])
+			{
+				_batch->lifeTime[i] -= _dt;
+			}
+
+			if (_batch->lifeTime[i] < 0)
+			{
+				_batch->lifeTime[i] = 0;
+			}
+			else if (_batch->lifeTime[i] > MAX_LIFE_TIME)
+			{
+				_batch->lifeTime[i] = MAX_LIFE_TIME;
+			}
+		}
+	}
+}
+#pragma endregion
+
+#if SIM_BATCH_X86
+#pragma region Sse2
+static __m128i Select128(__m128i _mask, __m128i _a, __m128i _b)
+{
+	return _mm_or_si128(_mm_and_si128(_mask, _a), _mm_andnot_si128(_mask, _b));
+}
+
+// Keeps the low half of each 64-bit mask lane: 2 + 2 lanes -> 4 lanes
+static __m128i Narrow128(__m128i _low, __m128i _high)
+{
+	return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(_low), _mm_castsi128_ps(_high), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// 0/1 per 64-bit lane to 0/-1
+static __m128i BitMask128(__m128i _bits)
+{
+	return _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(_bits, _mm_set_epi32(0, 1, 0, 1)));
+}
+
+// RandomNext on 4 games, the state only advances for the games in _mask
+static __m128i RandomNext128(SimBatch* const _batch, int _index, __m128i _mask)
+{
+	__m128i s0 = _mm_load_si128((const __m128i*)(_batch->random[0] + _index));
+	__m128i s1 = _mm_load_si128((const __m128i*)(_batch->random[1] + _index));
+	__m128i s2 = _mm_load_si128((const __m128i*)(_batch->random[2] + _index));
+	__m128i s3 = _mm_load_si128((const __m128i*)(_batch->random[3] + _index));
+
+	// No 32-bit multiply in SSE2: x * 5 and x * 9 are done with shifts
+	__m128i times5 = _mm_add_epi32(_mm_slli_epi32(s1, 2), s1);
+	__m128i rotated = _mm_or_si128(_mm_slli_epi32(times5, 7), _mm_srli_epi32(times5, 25));
+	__m128i result = _mm_add_epi32(_mm_slli_epi32(rotated, 3), rotated);
+	__m128i t = _mm_slli_epi32(s1, 9);
+
+	__m128i n2 = _mm_xor_si128(s2, s0);
+	__m128i n3 = _mm_xor_si128(s3, s1);
+	__m128i n1 = _mm_xor_si128(s1, n2);
+	__m128i n0 = _mm_xor_si128(s0, n3);
+	n2 = _mm_xor_si128(n2, t);
+	n3 = _mm_or_si128(_mm_slli_epi32(n3, 11), _mm_srli_epi32(n3, 21));
+
+	_mm_store_si128((__m128i*)(_batch->random[0] + _index), Select128(_mask, n0, s0));
+	_mm_store_si128((__m128i*)(_batch->random[1] + _index), Select128(_mask, n1, s1));
+	_mm_store_si128((__m128i*)(_batch->random[2] + _index), Select128(_mask, n2, s2));
+	_mm_store_si128((__m128i*)(_batch->random[3] + _index), Select128(_mask, n3, s3));
+	return result;
+}
+
+static void StepSse2(SimBatch* const _batch, float _dt)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi32(-1);
+	const __m128i topCount = _mm_cvtsi32_si128(_batch->height - 1);
+	const __m128i topBit = _mm_sll_epi64(_mm_set_epi32(0, 1, 0, 1), topCount);
+	const __m128 bonus = _mm_set1_ps(LIFE_BONUS);
+	const __m128 maxLife = _mm_set1_ps(MAX_LIFE_TIME);
+	const __m128 dt = _mm_set1_ps(_dt);
+
+	for (int i = 0; i < _batch->capacity; i += 4)
+	{
+		__m128i action = _mm_load_si128((const __m128i*)(_batch->action + i));
+		__m128i dead = _mm_load_si128((const __m128i*)(_batch->dead + i));
+		__m128i dir = _mm_load_si128((const __m128i*)(_batch->dir + i));
+		__m128i score = _mm_load_si128((const __m128i*)(_batch->score + i));
+		__m128 life = _mm_load_ps(_batch->lifeTime + i);
+
+		__m128i chop = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(action, zero), dead), ones);
+		__m128i chopLeft = _mm_cmpeq_epi32(action, _mm_set1_epi32(SIM_CHOP_LEFT));
+		dir = Select128(chop, Select128(chopLeft, ones, _mm_set1_epi32(1)), dir);
+		__m128i left = _mm_cmpeq_epi32(dir, ones);
+		__m128i left0 = _mm_unpacklo_epi32(left, left);
+		__m128i left1 = _mm_unpackhi_epi32(left, left);
+
+		__m128i branchLeft0 = _mm_load_si128((const __m128i*)(_batch->branchLeft + i));
+		__m128i branchLeft1 = _mm_load_si128((const __m128i*)(_batch->branchLeft + i + 2));
+		__m128i branchRight0 = _mm_load_si128((const __m128i*)(_batch->branchRight + i));
+		__m128i branchRight1 = _mm_load_si128((const __m128i*)(_batch->branchRight + i + 2));
+		__m128i bark0 = _mm_load_si128((const __m128i*)(_batch->bark + i));
+		__m128i bark1 = _mm_load_si128((const __m128i*)(_batch->bark + i + 2));
+
+		__m128i hit = Narrow128(BitMask128(Select128(left0, branchLeft0, branchRight0)),
+			BitMask128(Select128(left1, branchLeft1, branchRight1)));
+		__m128i hitFirst = _mm_and_si128(chop, hit);
+		__m128i ok = _mm_andnot_si128(hitFirst, chop);
+
+		life = _mm_add_ps(life, _mm_and_ps(_mm_castsi128_ps(ok), bonus));
+		score = _mm_sub_epi32(score, ok);
+
+		// New top segment, see SimShiftTrunc
+		__m128i topBranch = Narrow128(BitMask128(_mm_srl_epi64(_mm_or_si128(branchLeft0, branchRight0), topCount)),
+			BitMask128(_mm_srl_epi64(_mm_or_si128(branchLeft1, branchRight1), topCount)));
+		__m128i value = RandomNext128(_batch, i, ok);
+		__m128i random = _mm_srli_epi32(value, 30);
+		__m128i newLeft = _mm_andnot_si128(topBranch, _mm_cmpeq_epi32(random, _mm_set1_epi32(LEFT)));
+		__m128i newRight = _mm_andnot_si128(topBranch, _mm_cmpeq_epi32(random, _mm_set1_epi32(RIGHT)));
+		__m128i newBark = Select128(topBranch, _mm_srai_epi32(value, 31), _mm_cmpeq_epi32(random, _mm_set1_epi32(NORMAL2)));
+
+		__m128i ok0 = _mm_unpacklo_epi32(ok, ok);
+		__m128i ok1 = _mm_unpackhi_epi32(ok, ok);
+		branchLeft0 = Select128(ok0, _mm_or_si128(_mm_srli_epi64(branchLeft0, 1), _mm_and_si128(_mm_unpacklo_epi32(newLeft, newLeft), topBit)), branchLeft0);
+		branchLeft1 = Select128(ok1, _mm_or_si128(_mm_srli_epi64(branchLeft1, 1), _mm_and_si128(_mm_unpackhi_epi32(newLeft, newLeft), topBit)), branchLeft1);
+		branchRight0 = Select128(ok0, _mm_or_si128(_mm_srli_epi64(branchRight0, 1), _mm_and_si128(_mm_unpacklo_epi32(newRight, newRight), topBit)), branchRight0);
+		branchRight1 = Select128(ok1, _mm_or_si128(_mm_srli_epi64(branchRight1, 1), _mm_and_si128(_mm_unpackhi_epi32(newRight, newRight), topBit)), branchRight1);
+		bark0 = Select128(ok0, _mm_or_si128(_mm_srli_epi64(bark0, 1), _mm_and_si128(_mm_unpacklo_epi32(newBark, newBark), topBit)), bark0);
+		bark1 = Select128(ok1, _mm_or_si128(_mm_srli_epi64(bark1, 1), _mm_and_si128(_mm_unpackhi_epi32(newBark, newBark), topBit)), bark1);
+
+		hit = Narrow128(BitMask128(Select128(left0, branchLeft0, branchRight0)),
+			BitMask128(Select128(left1, branchLeft1, branchRight1)));
+		dead = _mm_or_si128(dead, _mm_or_si128(hitFirst, _mm_and_si128(ok, hit)));
+		dead = _mm_or_si128(dead, _mm_castps_si128(_mm_cmple_ps(life, _mm_setzero_ps())));
+
+		__m128 alive = _mm_castsi128_ps(_mm_andnot_si128(dead, ones));
+		__m128i isStarted = _mm_load_si128((const __m128i*)(_batch->isStarted + i));
+		__m128 drained = _mm_sub_ps(life, _mm_and_ps(_mm_castsi128_ps(isStarted), dt));
+		drained = _mm_min_ps(_mm_max_ps(drained, _mm_setzero_ps()), maxLife);
+		life = _mm_or_ps(_mm_and_ps(alive, drained), _mm_andnot_ps(alive, life));
+
+		_mm_store_si128((__m128i*)(_batch->dead + i), dead);
+		_mm_store_si128((__m128i*)(_batch->dir + i), dir);
+		_mm_store_si128((__m128i*)(_batch->score + i), score);
+		_mm_store_ps(_batch->lifeTime + i, life);
+		_mm_store_si128((__m128i*)(_batch->branchLeft + i), branchLeft0);
+		_mm_store_si128((__m128i*)(_batch->branchLeft + i + 2), branchLeft1);
+		_mm_store_si128((__m128i*)(_batch->branchRight + i), branchRight0);
+		_mm_store_si128((__m128i*)(_batch->branchRight + i + 2), branchRight1);
+		_mm_store_si128((__m128i*)(_batch->bark + i), bark0);
+		_mm_store_si128((__m128i*)(_batch->bark + i + 2), bark1);
+	}
+}
+#pragma endregion
+
+#pragma region Avx2
+// 4 lanes of 32-bit mask to 4 lanes of 64-bit mask, for lanes 0-3 or 4-7
+TARGET_AVX2 static __m256i Widen256(__m256i _mask, int _high)
+{
+	return _mm256_cvtepi32_epi64(_high ? _mm256_extracti128_si256(_mask, 1) : _mm256_castsi256_si128(_mask));
+}
+
+TARGET_AVX2 static __m256i Narrow256(__m256i _low, __m256i _high)
+{
+	const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+	__m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_low, even));
+	__m128i high = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_high, even));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+TARGET_AVX2 static __m256i BitMask256(__m256i _bits)
+{
+	const __m256i one = _mm256_set1_epi64x(1);
+	return _mm256_cmpeq_epi64(_mm256_and_si256(_bits, one), one);
+}
+
+TARGET_AVX2 static __m256i Shift256(__m256i _mask, __m256i _ok, __m256i _new, __m256i _topBit)
+{
+	return _mm256_blendv_epi8(_mask, _mm256_or_si256(_mm256_srli_epi64(_mask, 1), _mm256_and_si256(_new, _topBit)), _ok);
+}
+
+TARGET_AVX2 static __m256i RandomNext256(SimBatch* const _batch, int _index, __m256i _mask)
+{
+	__m256i s0 = _mm256_load_si256((const __m256i*)(_batch->random[0] + _index));
+	__m256i s1 = _mm256_load_si256((const __m256i*)(_batch->random[1] + _index));
+	__m256i s2 = _mm256_load_si256((const __m256i*)(_batch->random[2] + _index));
+	__m256i s3 = _mm256_load_si256((const __m256i*)(_batch->random[3] + _index));
+
+	__m256i times5 = _mm256_mullo_epi32(s1, _mm256_set1_epi32(5));
+	__m256i rotated = _mm256_or_si256(_mm256_slli_epi32(times5, 7), _mm256_srli_epi32(times5, 25));
+	__m256i result = _mm256_mullo_epi32(rotated, _mm256_set1_epi32(9));
+	__m256i t = _mm256_slli_epi32(s1, 9);
+
+	__m256i n2 = _mm256_xor_si256(s2, s0);
+	__m256i n3 = _mm256_xor_si256(s3, s1);
+	__m256i n1 = _mm256_xor_si256(s1, n2);
+	__m256i n0 = _mm256_xor_si256(s0, n3);
+	n2 = _mm256_xor_si256(n2, t);
+	n3 = _mm256_or_si256(_mm256_slli_epi32(n3, 11), _mm256_srli_epi32(n3, 21));
+
+	_mm256_store_si256((__m256i*)(_batch->random[0] + _index), _mm256_blendv_epi8(s0, n0, _mask));
+	_mm256_store_si256((__m256i*)(_batch->random[1] + _index), _mm256_blendv_epi8(s1, n1, _mask));
+	_mm256_store_si256((__m256i*)(_batch->random[2] + _index), _mm256_blendv_epi8(s2, n2, _mask));
+	_mm256_store_si256((__m256i*)(_batch->random[3] + _index), _mm256_blendv_epi8(s3, n3, _mask));
+	return result;
+}
+
+TARGET_AVX2 static void StepAvx2(SimBatch* const _batch, float _dt)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi32(-1);
+	const __m128i topCount = _mm_cvtsi32_si128(_batch->height - 1);
+	const __m256i topBit = _mm256_sll_epi64(_mm256_set1_epi64x(1), topCount);
+	const __m256 bonus = _mm256_set1_ps(LIFE_BONUS);
+	const __m256 maxLife = _mm256_set1_ps(MAX_LIFE_TIME);
+	const __m256 dt = _mm256_set1_ps(_dt);
+
+	for (int i = 0; i < _batch->capacity; i += 8)
+	{
+		__m256i action = _mm256_load_si256((const __m256i*)(_batch->action + i));
+		__m256i dead = _mm256_load_si256((const __m256i*)(_batch->dead + i));
+		__m256i dir = _mm256_load_si256((const __m256i*)(_batch->dir + i));
+		__m256i score = _mm256_load_si256((const __m256i*)(_batch->score + i));
+		__m256 life = _mm256_load_ps(_batch->lifeTime + i);
+
+		__m256i chop = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi32(action, zero), dead), ones);
+		__m256i chopLeft = _mm256_cmpeq_epi32(action, _mm256_set1_epi32(SIM_CHOP_LEFT));
+		dir = _mm256_blendv_epi8(dir, _mm256_blendv_epi8(_mm256_set1_epi32(1), ones, chopLeft), chop);
+		__m256i left = _mm256_cmpeq_epi32(dir, ones);
+		__m256i left0 = Widen256(left, 0);
+		__m256i left1 = Widen256(left, 1);
+
+		__m256i branchLeft0 = _mm256_load_si256((const __m256i*)(_batch->branchLeft + i));
+		__m256i branchLeft1 = _mm256_load_si256((const __m256i*)(_batch->branchLeft + i + 4));
+		__m256i branchRight0 = _mm256_load_si256((const __m256i*)(_batch->branchRight + i));
+		__m256i branchRight1 = _mm256_load_si256((const __m256i*)(_batch->branchRight + i + 4));
+		__m256i bark0 = _mm256_load_si256((const __m256i*)(_batch->bark + i));
+		__m256i bark1 = _mm256_load_si256((const __m256i*)(_batch->bark + i + 4));
+
+		__m256i hit = Narrow256(BitMask256(_mm256_blendv_epi8(branchRight0, branchLeft0, left0)),
+			BitMask256(_mm256_blendv_epi8(branchRight1, branchLeft1, left1)));
+		__m256i hitFirst = _mm256_and_si256(chop, hit);
+		__m256i ok = _mm256_andnot_si256(hitFirst, chop);
+
+		life = _mm256_add_ps(life, _mm256_and_ps(_mm256_castsi256_ps(ok), bonus));
+		score = _mm256_sub_epi32(score, ok);
+
+		// New top segment, see SimShiftTrunc
+		__m256i topBranch = Narrow256(BitMask256(_mm256_srl_epi64(_mm256_or_si256(branchLeft0, branchRight0), topCount)),
+			BitMask256(_mm256_srl_epi64(_mm256_or_si256(branchLeft1, branchRight1), topCount)));
+		__m256i value = RandomNext256(_batch, i, ok);
+		__m256i random = _mm256_srli_epi32(value, 30);
+		__m256i newLeft = _mm256_andnot_si256(topBranch, _mm256_cmpeq_epi32(random, _mm256_set1_epi32(LEFT)));
+		__m256i newRight = _mm256_andnot_si256(topBranch, _mm256_cmpeq_epi32(random, _mm256_set1_epi32(RIGHT)));
+		__m256i newBark = _mm256_blendv_epi8(_mm256_cmpeq_epi32(random, _mm256_set1_epi32(NORMAL2)), _mm256_srai_epi32(value, 31), topBranch);
+
+		__m256i ok0 = Widen256(ok, 0);
+		__m256i ok1 = Widen256(ok, 1);
+		branchLeft0 = Shift256(branchLeft0, ok0, Widen256(newLeft, 0), topBit);
+		branchLeft1 = Shift256(branchLeft1, ok1, Widen256(newLeft, 1), topBit);
+		branchRight0 = Shift256(branchRight0, ok0, Widen256(newRight, 0), topBit);
+		branchRight1 = Shift256(branchRight1, ok1, Widen256(newRight, 1), topBit);
+		bark0 = Shift256(bark0, ok0, Widen256(newBark, 0), topBit);
+		bark1 = Shift256(bark1, ok1, Widen256(newBark, 1), topBit);
+
+		hit = Narrow256(BitMask256(_mm256_blendv_epi8(branchRight0, branchLeft0, left0)),
+			BitMask256(_mm256_blendv_epi8(branchRight1, branchLeft1, left1)));
+		dead = _mm256_or_si256(dead, _mm256_or_si256(hitFirst, _mm256_and_si256(ok, hit)));
+		dead = _mm256_or_si256(dead, _mm256_castps_si256(_mm256_cmp_ps(life, _mm256_setzero_ps(), _CMP_LE_OQ)));
+
+		__m256 alive = _mm256_castsi256_ps(_mm256_andnot_si256(dead, ones));
+		__m256i isStarted = _mm256_load_si256((const __m256i*)(_batch->isStarted + i));
+		__m256 drained = _mm256_sub_ps(life, _mm256_and_ps(_mm256_castsi256_ps(isStarted), dt));
+		drained = _mm256_min_ps(_mm256_max_ps(drained, _mm256_setzero_ps()), maxLife);
+		life = _mm256_blendv_ps(life, drained, alive);
+
+		_mm256_store_si256((__m256i*)(_batch->dead + i), dead);
+		_mm256_store_si256((__m256i*)(_batch->dir + i), dir);
+		_mm256_store_si256((__m256i*)(_batch->score + i), score);
+		_mm256_store_ps(_batch->lifeTime + i, life);
+		_mm256_store_si256((__m256i*)(_batch->branchLeft + i), branchLeft0);
+		_mm256_store_si256((__m256i*)(_batch->branchLeft + i + 4), branchLeft1);
+		_mm256_store_si256((__m256i*)(_batch->branchRight + i), branchRight0);
+		_mm256_store_si256((__m256i*)(_batch->branchRight + i + 4), branchRight1);
+		_mm256_store_si256((__m256i*)(_batch->bark + i), bark0);
+		_mm256_store_si256((__m256i*)(_batch->bark + i + 4), bark1);
+	}
+}
+#pragma endregion
+#endif
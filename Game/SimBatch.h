@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include "Simulation.h"
+
+// Advances many independent games at once. State is stored as one array
+// per field so the step can run 4 (SSE2) or 8 (AVX2) games per instruction.
+// The rules are baked into the SIMD code: batches always play the default SimConfig.
+
+#pragma region Define
+#define SIM_BATCH_WIDTH 8
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum SimBatchPath
+{
+	SIM_BATCH_SCALAR,
+	SIM_BATCH_SSE2,
+	SIM_BATCH_AVX2,
+}SimBatchPath;
+
+typedef struct SimBatch
+{
+	int count;
+	int capacity;
+	int height;
+	SimBatchPath path;
+
+	float* lifeTime;
+	int32_t* score;
+	int32_t* dir;
+	// 0 or -1 so they can be used directly as SIMD lane masks
+	int32_t* dead;
+	int32_t* isStarted;
+	// Filled by the caller with a SimAction per game before each step
+	int32_t* action;
+	// One array per word of each game's Random state
+	uint32_t* random[4];
+
+	uint64_t* branchLeft;
+	uint64_t* branchRight;
+	uint64_t* bark;
+}SimBatch;
+#pragma endregion
+
+#pragma region Definition
+bool SimBatchCreate(SimBatch* const _batch, int _count, int _height, uint64_t _seed);
+void SimBatchDestroy(SimBatch* const _batch);
+
+void SimBatchReset(SimBatch* const _batch, int _index);
+void SimBatchStart(SimBatch* const _batch);
+void SimBatchStep(SimBatch* const _batch, float _dt);
+void SimBatchGet(const SimBatch* const _batch, int _index, Simulation* const _sim);
+
+SimBatchPath SimBatchDetectPath(void);
+const char* SimBatchPathName(SimBatchPath _path);
+#pragma endregion
@@ -0,0 +1,187 @@
+#include <stddef.h>
+#include "Simulation.h"
+
+void SimConfigDefault(SimConfig* const _config)
+{
+	_config->startLifeTime = START_LIFE_TIME;
+	_config->lifeBonus = LIFE_BONUS;
+	_config->maxLifeTime = MAX_LIFE_TIME;
+	_config->branchChance = DEFAULT_BRANCH_CHANCE;
+}
+
+void SimSeed(Simulation* const _sim, uint64_t _seed, int _stream)
+{
+	SimConfigDefault(&_sim->config);
+	RandomSeed(&_sim->random, _seed);
+	for (int i = 0; i < _stream; i++)
+	{
+		RandomJump(&_sim->random);
+	}
+}
+
+void SimReset(Simulation* const _sim, int _height)
+{
+	if (_height < 1)
+	{
+		_height = 1;
+	}
+	else if (_height > MAX_TRUNC_COUNT)
+	{
+		_height = MAX_TRUNC_COUNT;
+	}
+
+	_sim->height = _height;
+	_sim->tick = 0;
+	_sim->branchLeft = 0;
+	_sim->branchRight = 0;
+	_sim->bark = 0;
+	for (int i = 0; i < _height; i++)
+	{
+		SimSetTrunc(_sim, i, RandomNext(&_sim->random) >> 31);
+	}
+	_sim->lifeTime = _sim->config.startLifeTime;
+	_sim->score = 0;
+	_sim->dir = BASE_POSITION;
+	_sim->dead = false;
+	_sim->isStarted = false;
+}
+
+void SimStart(Simulation* const _sim)
+{
+	_sim->isStarted = true;
+}
+
+void SimStep(Simulation* const _sim, SimAction _action, float _dt)
+{
+	_sim->tick++;
+	if (_action != SIM_NONE && !_sim->dead)
+	{
+		_sim->dir = _action == SIM_CHOP_LEFT ? -1 : 1;
+		_sim->dead = SimCheckCollide(_sim);
+		if (!_sim->dead)
+		{
+			_sim->lifeTime += _sim->config.lifeBonus;
+			_sim->score++;
+			SimShiftTrunc(_sim);
+			_sim->dead = SimCheckCollide(_sim);
+		}
+	}
+
+	if (_sim->lifeTime <= 0)
+	{
+		_sim->dead = true;
+	}
+
+	if (!_sim->dead)
+	{
+		if (_sim->isStarted)
+		{
+			_sim->lifeTime -= _dt;
+		}
+
+		if (_sim->lifeTime < 0)
+		{
+			_sim->lifeTime = 0;
+		}
+		else if (_sim->lifeTime > _sim->config.maxLifeTime)
+		{
+			_sim->lifeTime = _sim->config.maxLifeTime;
+		}
+	}
+}
+
+bool SimCheckCollide(const Simulation* const _sim)
+{
+	// Only the lowest segment can hit the player
+	uint64_t branch = _sim->dir == -1 ? _sim->branchLeft : _sim->branchRight;
+	return branch & 1;
+}
+
+void SimShiftTrunc(Simulation* const _sim)
+{
+	int top = _sim->height - 1;
+	uint64_t topBranch = ((_sim->branchLeft | _sim->branchRight) >> top) & 1;
+
+	_sim->branchLeft >>= 1;
+	_sim->branchRight >>= 1;
+	_sim->bark >>= 1;
+
+	// Never two branches in a row, otherwise the player could be trapped
+	uint32_t random = RandomNext(&_sim->random);
+	SimSetTrunc(_sim, top, topBranch ? random >> 31 : SimDrawTrunc(&_sim->config, random));
+}
+
+TruncType SimDrawTrunc(const SimConfig* const _config, uint32_t _random)
+{
+	// Bit 30 picks the side (or the bark), the other 31 bits roll the branch.
+	// With a 0.5 chance this is exactly _random >> 30, as the game always did.
+	uint32_t roll = (_random & 0x80000000u) | ((_random & 0x3FFFFFFFu) << 1);
+	uint32_t side = (_random >> 30) & 1;
+	bool isBranch = roll >= (1.0 - _config->branchChance) * 4294967296.0;
+	return (isBranch ? LEFT : NORMAL) + side;
+}
+
+void SimSetTrunc(Simulation* const _sim, int _segment, TruncType _truncType)
+{
+	uint64_t bit = (uint64_t)1 << _segment;
+	_sim->branchLeft &= ~bit;
+	_sim->branchRight &= ~bit;
+	_sim->bark &= ~bit;
+
+	switch (_truncType)
+	{
+	case NORMAL2:
+		_sim->bark |= bit;
+		break;
+	case LEFT:
+		_sim->branchLeft |= bit;
+		break;
+	case RIGHT:
+		_sim->branchRight |= bit;
+		break;
+	default:
+		break;
+	}
+}
+
+TruncType SimGetTrunc(const Simulation* const _sim, int _segment)
+{
+	if ((_sim->branchLeft >> _segment) & 1)
+	{
+		return LEFT;
+	}
+	if ((_sim->branchRight >> _segment) & 1)
+	{
+		return RIGHT;
+	}
+	return ((_sim->bark >> _segment) & 1) ? NORMAL2 : NORMAL;
+}
+
+static uint64_t HashBytes(uint64_t _hash, const void* _data, size_t _size)
+{
+	const unsigned char* bytes = _data;
+	for (size_t i = 0; i < _size; i++)
+	{
+		_hash = (_hash ^ bytes[i]) * 0x100000001B3ull;
+	}
+	return _hash;
+}
+
+uint64_t SimHash(const Simulation* const _sim)
+{
+	// FNV-1a over every field that drives the rules, padding excluded
+	uint64_t hash = 0xCBF29CE484222325ull;
+	uint8_t flags[2] = { _sim->dead, _sim->isStarted };
+	hash = HashBytes(hash, &_sim->branchLeft, sizeof(_sim->branchLeft));
+	hash = HashBytes(hash, &_sim->branchRight, sizeof(_sim->branchRight));
+	hash = HashBytes(hash, &_sim->bark, sizeof(_sim->bark));
+	hash = HashBytes(hash, &_sim->height, sizeof(_sim->height));
+	hash = HashBytes(hash, &_sim->tick, sizeof(_sim->tick));
+	hash = HashBytes(hash, &_sim->lifeTime, sizeof(_sim->lifeTime));
+	hash = HashBytes(hash, &_sim->score, sizeof(_sim->score));
+	hash = HashBytes(hash, &_sim->dir, sizeof(_sim->dir));
+	hash = HashBytes(hash, flags, sizeof(flags));
+	hash = HashBytes(hash, _sim->random.state, sizeof(_sim->random.state));
+	hash = HashBytes(hash, &_sim->config, sizeof(_sim->config));
+	return hash;
+}
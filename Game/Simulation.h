@@ -0,0 +1,80 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "Random.h"
+
+// Headless game rules: no CSFML type may appear in this module so that it
+// can be linked into tools and bots without a window or a GPU context.
+
+#pragma region Define
+#define DEFAULT_TRUNC_COUNT 6
+#define MAX_TRUNC_COUNT 64
+#define START_LIFE_TIME 5
+#define LIFE_BONUS 0.2f
+#define MAX_LIFE_TIME 10
+#define DEFAULT_BRANCH_CHANCE 0.5f
+#define BASE_POSITION -1
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum TruncType
+{
+	NORMAL,
+	NORMAL2,
+	LEFT,
+	RIGHT,
+}TruncType;
+
+typedef enum SimAction
+{
+	SIM_NONE,
+	SIM_CHOP_LEFT,
+	SIM_CHOP_RIGHT,
+}SimAction;
+
+// Tunable rules, the defines above are the shipped values
+typedef struct SimConfig
+{
+	float startLifeTime;
+	float lifeBonus;
+	float maxLifeTime;
+	// Chance for a segment to carry a branch, unless the one below already has one
+	float branchChance;
+}SimConfig;
+
+typedef struct Simulation
+{
+	// One bit per segment, bit 0 is the lowest segment
+	uint64_t branchLeft;
+	uint64_t branchRight;
+	uint64_t bark;
+	int height;
+	uint32_t tick;
+	float lifeTime;
+	int score;
+	int dir;
+	bool dead;
+	bool isStarted;
+	Random random;
+	SimConfig config;
+}Simulation;
+#pragma endregion
+
+#pragma region Definition
+void SimConfigDefault(SimConfig* const _config);
+
+// Also restores the default config, change _sim->config after seeding
+void SimSeed(Simulation* const _sim, uint64_t _seed, int _stream);
+void SimReset(Simulation* const _sim, int _height);
+void SimStart(Simulation* const _sim);
+void SimStep(Simulation* const _sim, SimAction _action, float _dt);
+
+bool SimCheckCollide(const Simulation* const _sim);
+void SimShiftTrunc(Simulation* const _sim);
+TruncType SimDrawTrunc(const SimConfig* const _config, uint32_t _random);
+
+void SimSetTrunc(Simulation* const _sim, int _segment, TruncType _truncType);
+TruncType SimGetTrunc(const Simulation* const _sim, int _segment);
+
+uint64_t SimHash(const Simulation* const _sim);
+#pragma endregion
@@ -0,0 +1,113 @@
+#include <math.h>
+#include "Solver.h"
+
+SimAction SolverChoose(const Simulation* const _sim)
+{
+	bool isLeftSafe = !(_sim->branchLeft & SOLVER_SAFE_MASK);
+	bool isRightSafe = !(_sim->branchRight & SOLVER_SAFE_MASK);
+
+	// Stay on the current side when possible, like a player would
+	if (_sim->dir == 1 && isRightSafe)
+	{
+		return SIM_CHOP_RIGHT;
+	}
+	if (isLeftSafe)
+	{
+		return SIM_CHOP_LEFT;
+	}
+	if (isRightSafe)
+	{
+		return SIM_CHOP_RIGHT;
+	}
+	return SIM_NONE;
+}
+
+void SolverFillBatch(SimBatch* const _batch)
+{
+	// Branch-free so the compiler can vectorise it over the batch arrays
+	for (int i = 0; i < _batch->capacity; i++)
+	{
+		int32_t isLeftSafe = !(_batch->branchLeft[i] & SOLVER_SAFE_MASK);
+		int32_t isRightSafe = !(_batch->branchRight[i] & SOLVER_SAFE_MASK);
+		int32_t keepRight = _batch->dir[i] == 1 && isRightSafe;
+		int32_t action = keepRight ? SIM_CHOP_RIGHT : (isLeftSafe ? SIM_CHOP_LEFT : (isRightSafe ? SIM_CHOP_RIGHT : SIM_NONE));
+		_batch->action[i] = _batch->dead[i] ? SIM_NONE : action;
+	}
+}
+
+void SolverFixedPolicy(SolverPolicy* const _policy, float _chopRate)
+{
+	_policy->name = "fixed";
+	_policy->reactionMean = 1.f / _chopRate;
+	_policy->reactionDeviation = 0;
+	_policy->minInterval = 0;
+	_policy->errorRate = 0;
+}
+
+float SolverMinChopRate(const SimConfig* const _config)
+{
+	// The life bar drains one unit per second and every chop gives lifeBonus back
+	return 1.f / _config->lifeBonus;
+}
+
+float SolverSurvivalTime(const SimConfig* const _config, float _lifeTime, float _chopRate)
+{
+	float gain = _chopRate * _config->lifeBonus - 1.f;
+	if (gain >= 0)
+	{
+		return -1.f;
+	}
+	// The bar never holds more than maxLifeTime, then it only drains
+	float lifeTime = _lifeTime < _config->maxLifeTime ? _lifeTime : _config->maxLifeTime;
+	return lifeTime / -gain;
+}
+
+static float NextInterval(const SolverPolicy* const _policy, Random* const _random)
+{
+	float interval = _policy->reactionMean;
+	if (_policy->reactionDeviation > 0)
+	{
+		// Box-Muller, then a log-normal with the requested mean and deviation
+		float u = 1.f - RandomFloat(_random);
+		float v = RandomFloat(_random);
+		float normal = sqrtf(-2.f * logf(u)) * cosf(6.2831853f * v);
+		float ratio = _policy->reactionDeviation / _policy->reactionMean;
+		float sigma2 = logf(1.f + ratio * ratio);
+		interval = expf(logf(_policy->reactionMean) - sigma2 * 0.5f + sqrtf(sigma2) * normal);
+	}
+	return interval > _policy->minInterval ? interval : _policy->minInterval;
+}
+
+SolverResult SolverPlay(Simulation* const _sim, const SolverPolicy* const _policy, Random* const _random, int _tickRate, uint32_t _maxTicks)
+{
+	SolverResult result = { 0 };
+	float tickTime = 1.f / _tickRate;
+	// Chops are scheduled on an absolute clock so a fixed rate does not drift
+	double nextChop = NextInterval(_policy, _random);
+
+	SimStart(_sim);
+	while (!_sim->dead && _sim->tick < _maxTicks)
+	{
+		SimAction action = SIM_NONE;
+		if ((double)_sim->tick / _tickRate >= nextChop)
+		{
+			nextChop += NextInterval(_policy, _random);
+			action = SolverChoose(_sim);
+			if (action == SIM_NONE)
+			{
+				result.isStuck = true;
+				break;
+			}
+			if (_policy->errorRate > 0 && RandomFloat(_random) < _policy->errorRate)
+			{
+				action = action == SIM_CHOP_LEFT ? SIM_CHOP_RIGHT : SIM_CHOP_LEFT;
+			}
+		}
+		SimStep(_sim, action, tickTime);
+	}
+
+	result.score = _sim->score;
+	result.ticks = _sim->tick;
+	result.isDead = _sim->dead;
+	return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "Random.h"
+#include "Simulation.h"
+#include "SimBatch.h"
+
+// Perfect-play bot. A chop tests the lowest segment before and after the
+// shift (see SimStep), so a side is safe when neither of the two lowest
+// segments carries a branch on that side.
+
+#pragma region Define
+#define SOLVER_SAFE_MASK 3
+#pragma endregion
+
+#pragma region Struct and Enum
+// How fast and how well the bot plays, from perfect play to human-like
+typedef struct SolverPolicy
+{
+	const char* name;
+	// Seconds between two chops, log-normal like human reaction times
+	float reactionMean;
+	float reactionDeviation;
+	// No chop can come sooner, the cutting animation sets this in game
+	float minInterval;
+	// Chance to chop on the wrong side
+	float errorRate;
+}SolverPolicy;
+
+typedef struct SolverResult
+{
+	int score;
+	uint32_t ticks;
+	bool isDead;
+	// No safe side was found: the generator produced an unwinnable column
+	bool isStuck;
+}SolverResult;
+#pragma endregion
+
+#pragma region Definition
+SimAction SolverChoose(const Simulation* const _sim);
+void SolverFillBatch(SimBatch* const _batch);
+
+void SolverFixedPolicy(SolverPolicy* const _policy, float _chopRate);
+float SolverMinChopRate(const SimConfig* const _config);
+// Seconds until the bar starting at _lifeTime runs out at a steady chop rate, -1 if it never does
+float SolverSurvivalTime(const SimConfig* const _config, float _lifeTime, float _chopRate);
+SolverResult SolverPlay(Simulation* const _sim, const SolverPolicy* const _policy, Random* const _random, int _tickRate, uint32_t _maxTicks);
+#pragma endregion
@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "SpriteBatch.h"
+
+static int CompareInstance(const void* _a, const void* _b)
+{
+	const SpriteInstance* a = _a;
+	const SpriteInstance* b = _b;
+	if (a->layer != b->layer)
+	{
+		return a->layer < b->layer ? -1 : 1;
+	}
+	if (a->blend != b->blend)
+	{
+		return a->blend < b->blend ? -1 : 1;
+	}
+	if (a->texture != b->texture)
+	{
+		return (uintptr_t)a->texture < (uintptr_t)b->texture ? -1 : 1;
+	}
+	return (a->order > b->order) - (a->order < b->order);
+}
+
+static bool Reserve(SpriteBatch* const _batch, int _capacity)
+{
+	if (_capacity <= _batch->capacity)
+	{
+		return true;
+	}
+	int capacity = _batch->capacity ? _batch->capacity : SPRITE_BATCH_CAPACITY;
+	while (capacity < _capacity)
+	{
+		capacity *= 2;
+	}
+
+	SpriteInstance* instances = realloc(_batch->instances, capacity * sizeof(SpriteInstance));
+	if (!instances)
+	{
+		return false;
+	}
+	_batch->instances = instances;
+	sfVertex* vertices = realloc(_batch->vertices, capacity * 4 * sizeof(sfVertex));
+	if (!vertices)
+	{
+		return false;
+	}
+	_batch->vertices = vertices;
+	SpriteDraw* draws = realloc(_batch->draws, capacity * sizeof(SpriteDraw));
+	if (!draws)
+	{
+		return false;
+	}
+	_batch->draws = draws;
+	_batch->capacity = capacity;
+	return true;
+}
+
+bool SpriteBatchCreate(SpriteBatch* const _batch)
+{
+	*_batch = (SpriteBatch){ 0 };
+	return Reserve(_batch, SPRITE_BATCH_CAPACITY);
+}
+
+void SpriteBatchDestroy(SpriteBatch* const _batch)
+{
+	free(_batch->instances);
+	free(_batch->vertices);
+	free(_batch->draws);
+	*_batch = (SpriteBatch){ 0 };
+}
+
+void SpriteBatchBegin(SpriteBatch* const _batch)
+{
+	_batch->count = 0;
+	_batch->drawCount = 0;
+}
+
+void SpriteBatchAdd(SpriteBatch* const _batch, int _layer, const sfTexture* _texture, sfIntRect _rect, sfTransform _transform, sfColor _color, SpriteBlend _blend)
+{
+	if (!Reserve(_batch, _batch->count + 1))
+	{
+		return;
+	}
+	_batch->instances[_batch->count] = (SpriteInstance){ _texture, _rect, _transform, _color, _blend, _layer, _batch->count };
+	_batch->count++;
+}
+
+void SpriteBatchAddSprite(SpriteBatch* const _batch, int _layer, const sfSprite* _sprite)
+{
+	SpriteBatchAdd(_batch, _layer, sfSprite_getTexture(_sprite), sfSprite_getTextureRect(_sprite),
+		sfSprite_getTransform(_sprite), sfSprite_getColor(_sprite), SPRITE_BLEND_ALPHA);
+}
+
+void SpriteBatchEnd(SpriteBatch* const _batch)
+{
+	qsort(_batch->instances, _batch->count, sizeof(SpriteInstance), CompareInstance);
+
+	SpriteDraw* draw = NULL;
+	for (int i = 0; i < _batch->count; i++)
+	{
+		const SpriteInstance* instance = &_batch->instances[i];
+		if (!draw || draw->texture != instance->texture || draw->blend != instance->blend)
+		{
+			draw = &_batch->draws[_batch->drawCount++];
+			*draw = (SpriteDraw){ instance->texture, instance->blend, i * 4, 0 };
+		}
+
+		// Same corners as sfSprite: the local rect is the size of the texture rect
+		sfIntRect rect = instance->rect;
+		float width = (float)abs(rect.width);
+		float height = (float)abs(rect.height);
+		sfVector2f corners[4] = { { 0, 0 }, { width, 0 }, { width, height }, { 0, height } };
+		float left = (float)rect.left;
+		float right = (float)(rect.left + rect.width);
+		float top = (float)rect.top;
+		float bottom = (float)(rect.top + rect.height);
+		sfVector2f texCoords[4] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+
+		sfVertex* vertices = &_batch->vertices[i * 4];
+		for (int corner = 0; corner < 4; corner++)
+		{
+			vertices[corner].position = sfTransform_transformPoint(&instance->transform, corners[corner]);
+			vertices[corner].color = instance->color;
+			vertices[corner].texCoords = texCoords[corner];
+		}
+		draw->vertexCount += 4;
+	}
+}
+
+// By value: the CSFML blend modes are imported from the DLL, their addresses are no constant initializer
+static sfBlendMode BlendMode(SpriteBlend _blend)
+{
+	switch (_blend)
+	{
+	case SPRITE_BLEND_ADD:
+		return sfBlendAdd;
+	case SPRITE_BLEND_MULTIPLY:
+		return sfBlendMultiply;
+	case SPRITE_BLEND_NONE:
+		return sfBlendNone;
+	default:
+		return sfBlendAlpha;
+	}
+}
+
+sfRenderStates SpriteBatchStates(const SpriteDraw* const _draw)
+{
+	// The vertices are already in world space
+	return (sfRenderStates) { BlendMode(_draw->blend), sfTransform_Identity, _draw->texture, NULL };
+}
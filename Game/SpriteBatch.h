@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <SFML/Graphics.h>
+
+// Sprite batcher: sprites are queued as instances (texture region, transform,
+// colour), sorted by layer, blend mode and texture, then turned into one quad
+// list where every run sharing a texture and a blend mode is a single draw.
+// Inside a layer sprites are reordered, overlapping sprites need two layers.
+
+#pragma region Define
+// Instances before the first growth, the arrays only grow
+#define SPRITE_BATCH_CAPACITY 128
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum SpriteBlend
+{
+	SPRITE_BLEND_ALPHA,
+	SPRITE_BLEND_ADD,
+	SPRITE_BLEND_MULTIPLY,
+	SPRITE_BLEND_NONE,
+	SPRITE_BLEND_COUNT,
+}SpriteBlend;
+
+typedef struct SpriteInstance
+{
+	const sfTexture* texture;
+	sfIntRect rect;
+	sfTransform transform;
+	sfColor color;
+	SpriteBlend blend;
+	int layer;
+	// Submission order, keeps the sort stable
+	int order;
+}SpriteInstance;
+
+// A run of quads drawn with one call
+typedef struct SpriteDraw
+{
+	const sfTexture* texture;
+	SpriteBlend blend;
+	int firstVertex;
+	int vertexCount;
+}SpriteDraw;
+
+typedef struct SpriteBatch
+{
+	SpriteInstance* instances;
+	int count;
+	int capacity;
+	sfVertex* vertices;
+	SpriteDraw* draws;
+	int drawCount;
+}SpriteBatch;
+#pragma endregion
+
+#pragma region Definition
+bool SpriteBatchCreate(SpriteBatch* const _batch);
+void SpriteBatchDestroy(SpriteBatch* const _batch);
+
+// Drops the instances and the draws of the previous frame
+void SpriteBatchBegin(SpriteBatch* const _batch);
+void SpriteBatchAdd(SpriteBatch* const _batch, int _layer, const sfTexture* _texture, sfIntRect _rect, sfTransform _transform, sfColor _color, SpriteBlend _blend);
+// Takes the texture, texture rect, transform and colour the sprite has now
+void SpriteBatchAddSprite(SpriteBatch* const _batch, int _layer, const sfSprite* _sprite);
+// Sorts the instances and fills the vertices and the draws
+void SpriteBatchEnd(SpriteBatch* const _batch);
+sfRenderStates SpriteBatchStates(const SpriteDraw* const _draw);
+#pragma endregion
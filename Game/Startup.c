@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include "File.h"
+#include "Timer.h"
+#include "Startup.h"
+
+#pragma region Definition
+static double TicksToMs(int64_t _ticks);
+static StartupAsset* FindAsset(StartupRun* const _run, const char* _name);
+static void ClearRun(StartupRun* const _run);
+#pragma endregion
+
+// Only the main thread records, the loader jobs hand their times over once they are done
+static StartupRun run;
+static int64_t origin;
+static bool isRunning;
+
+static const char* milestoneNames[STARTUP_MILESTONE_COUNT] = { "main", "window", "firstDisplay", "loaded", "interactive" };
+
+void StartupBegin(int64_t _origin)
+{
+	ClearRun(&run);
+	origin = _origin ? _origin : TimerTicks();
+	isRunning = true;
+}
+
+bool StartupIsRunning(void)
+{
+	return isRunning;
+}
+
+void StartupMark(StartupMilestone _milestone, int64_t _time)
+{
+	// Only the first time counts, the loading screen is displayed many times
+	if (isRunning && run.milestones[_milestone] < 0)
+	{
+		run.milestones[_milestone] = TicksToMs(_time - origin);
+	}
+}
+
+void StartupAddAsset(const char* _name, int64_t _io, int64_t _decode, int64_t _upload)
+{
+	StartupAsset* asset = isRunning ? FindAsset(&run, _name) : NULL;
+	if (asset)
+	{
+		asset->ioMs += TicksToMs(_io);
+		asset->decodeMs += TicksToMs(_decode);
+		asset->uploadMs += TicksToMs(_upload);
+	}
+}
+
+const StartupRun* StartupGetRun(void)
+{
+	return &run;
+}
+
+bool StartupWriteRun(const StartupRun* const _run, const char* _path)
+{
+	FILE* file = FileOpen(_path, "w");
+	if (!file)
+	{
+		return false;
+	}
+	for (int i = 0; i < STARTUP_MILESTONE_COUNT; i++)
+	{
+		fprintf(file, "milestone %s %.3f\n", milestoneNames[i], _run->milestones[i]);
+	}
+	for (int i = 0; i < _run->assetCount; i++)
+	{
+		const StartupAsset* asset = &_run->assets[i];
+		fprintf(file, "asset %s %.3f %.3f %.3f\n", asset->name, asset->ioMs, asset->decodeMs, asset->uploadMs);
+	}
+	bool isWritten = !ferror(file);
+	fclose(file);
+	return isWritten;
+}
+
+bool StartupReadRun(StartupRun* const _run, const char* _path)
+{
+	ClearRun(_run);
+	FILE* file = FileOpen(_path, "r");
+	if (!file)
+	{
+		return false;
+	}
+
+	char line[256];
+	char milestoneFormat[32];
+	char assetFormat[32];
+	snprintf(milestoneFormat, sizeof(milestoneFormat), "milestone %%%ds %%lf", STARTUP_NAME_LENGTH - 1);
+	snprintf(assetFormat, sizeof(assetFormat), "asset %%%ds %%lf %%lf %%lf", STARTUP_NAME_LENGTH - 1);
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[STARTUP_NAME_LENGTH];
+		double value = 0;
+		StartupAsset read = { 0 };
+		if (FileScan(line, milestoneFormat, FILE_SCAN_STRING(name), &value) == 2)
+		{
+			for (int i = 0; i < STARTUP_MILESTONE_COUNT; i++)
+			{
+				if (strcmp(name, milestoneNames[i]) == 0)
+				{
+					_run->milestones[i] = value;
+				}
+			}
+		}
+		else if (FileScan(line, assetFormat, FILE_SCAN_STRING(read.name), &read.ioMs, &read.decodeMs, &read.uploadMs) == 4)
+		{
+			StartupAsset* asset = FindAsset(_run, read.name);
+			if (asset)
+			{
+				*asset = read;
+			}
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+const char* StartupMilestoneName(StartupMilestone _milestone)
+{
+	return milestoneNames[_milestone];
+}
+
+static double TicksToMs(int64_t _ticks)
+{
+	return _ticks * 1000.0 / TimerFrequency();
+}
+
+static StartupAsset* FindAsset(StartupRun* const _run, const char* _name)
+{
+	for (int i = 0; i < _run->assetCount; i++)
+	{
+		if (strcmp(_run->assets[i].name, _name) == 0)
+		{
+			return &_run->assets[i];
+		}
+	}
+	if (_run->assetCount == STARTUP_MAX_ASSETS)
+	{
+		return NULL;
+	}
+	StartupAsset* asset = &_run->assets[_run->assetCount++];
+	*asset = (StartupAsset){ 0 };
+	snprintf(asset->name, STARTUP_NAME_LENGTH, "%s", _name);
+	return asset;
+}
+
+static void ClearRun(StartupRun* const _run)
+{
+	*_run = (StartupRun){ 0 };
+	for (int i = 0; i < STARTUP_MILESTONE_COUNT; i++)
+	{
+		_run->milestones[i] = -1;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Startup timings of one run: milestones from the process start (or from
+// the origin the benchmark passes on the command line), and per asset the
+// time spent reading and checking it, decoding it and uploading it. The game
+// records them with --startup-report, StartupBench runs it many times and
+// reads the reports back.
+//
+// Report on disk, one record per line:
+// milestone <name> <ms>, asset <name> <io ms> <decode ms> <upload ms>
+
+#pragma region Define
+#define STARTUP_MAX_ASSETS 32
+#define STARTUP_NAME_LENGTH 48
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum StartupMilestone
+{
+	// Entry of main: loading the executable and its libraries
+	STARTUP_MAIN,
+	STARTUP_WINDOW,
+	// The loading screen is on screen
+	STARTUP_FIRST_DISPLAY,
+	// Every asset is decoded and uploaded
+	STARTUP_LOADED,
+	// First frame of the menu, the game takes input
+	STARTUP_INTERACTIVE,
+	STARTUP_MILESTONE_COUNT,
+}StartupMilestone;
+
+typedef struct StartupAsset
+{
+	char name[STARTUP_NAME_LENGTH];
+	double ioMs;
+	double decodeMs;
+	double uploadMs;
+}StartupAsset;
+
+typedef struct StartupRun
+{
+	// Milliseconds from the origin, negative if never reached
+	double milestones[STARTUP_MILESTONE_COUNT];
+	StartupAsset assets[STARTUP_MAX_ASSETS];
+	int assetCount;
+}StartupRun;
+#pragma endregion
+
+#pragma region Definition
+// _origin in TimerTicks, 0 for now. Recording functions do nothing before.
+void StartupBegin(int64_t _origin);
+bool StartupIsRunning(void);
+void StartupMark(StartupMilestone _milestone, int64_t _time);
+// Times in TimerTicks, added to what the asset already had
+void StartupAddAsset(const char* _name, int64_t _io, int64_t _decode, int64_t _upload);
+const StartupRun* StartupGetRun(void);
+
+bool StartupWriteRun(const StartupRun* const _run, const char* _path);
+bool StartupReadRun(StartupRun* const _run, const char* _path);
+const char* StartupMilestoneName(StartupMilestone _milestone);
+#pragma endregion
@@ -0,0 +1,132 @@
+#include "Thread.h"
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static unsigned __stdcall ThreadEntry(void* _thread)
+{
+	Thread* thread = _thread;
+	thread->function(thread->userData);
+	return 0;
+}
+#else
+static void* ThreadEntry(void* _thread)
+{
+	Thread* thread = _thread;
+	thread->function(thread->userData);
+	return NULL;
+}
+#endif
+
+bool ThreadStart(Thread* const _thread, void (*_function)(void*), void* _userData)
+{
+	_thread->function = _function;
+	_thread->userData = _userData;
+#ifdef _WIN32
+	_thread->handle = _beginthreadex(NULL, 0, ThreadEntry, _thread, 0, NULL);
+	return _thread->handle != 0;
+#else
+	return pthread_create(&_thread->handle, NULL, ThreadEntry, _thread) == 0;
+#endif
+}
+
+void ThreadWait(Thread* const _thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)_thread->handle, INFINITE);
+	CloseHandle((HANDLE)_thread->handle);
+#else
+	pthread_join(_thread->handle, NULL);
+#endif
+}
+
+int ThreadHardwareCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+void ThreadYield(void)
+{
+#ifdef _WIN32
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+bool SemaphoreCreate(Semaphore* const _semaphore)
+{
+#ifdef _WIN32
+	_semaphore->handle = CreateSemaphoreW(NULL, 0, 0x7FFFFFFF, NULL);
+	return _semaphore->handle != NULL;
+#else
+	_semaphore->count = 0;
+	if (pthread_mutex_init(&_semaphore->mutex, NULL) != 0)
+	{
+		return false;
+	}
+	if (pthread_cond_init(&_semaphore->condition, NULL) != 0)
+	{
+		pthread_mutex_destroy(&_semaphore->mutex);
+		return false;
+	}
+	return true;
+#endif
+}
+
+void SemaphoreDestroy(Semaphore* const _semaphore)
+{
+#ifdef _WIN32
+	CloseHandle(_semaphore->handle);
+	_semaphore->handle = NULL;
+#else
+	pthread_cond_destroy(&_semaphore->condition);
+	pthread_mutex_destroy(&_semaphore->mutex);
+#endif
+}
+
+void SemaphorePost(Semaphore* const _semaphore, int _count)
+{
+#ifdef _WIN32
+	ReleaseSemaphore(_semaphore->handle, _count, NULL);
+#else
+	pthread_mutex_lock(&_semaphore->mutex);
+	_semaphore->count += _count;
+	pthread_mutex_unlock(&_semaphore->mutex);
+	if (_count == 1)
+	{
+		pthread_cond_signal(&_semaphore->condition);
+	}
+	else
+	{
+		pthread_cond_broadcast(&_semaphore->condition);
+	}
+#endif
+}
+
+void SemaphoreWait(Semaphore* const _semaphore)
+{
+#ifdef _WIN32
+	WaitForSingleObject(_semaphore->handle, INFINITE);
+#else
+	pthread_mutex_lock(&_semaphore->mutex);
+	while (_semaphore->count == 0)
+	{
+		pthread_cond_wait(&_semaphore->condition, &_semaphore->mutex);
+	}
+	_semaphore->count--;
+	pthread_mutex_unlock(&_semaphore->mutex);
+#endif
+}
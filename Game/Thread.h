@@ -0,0 +1,52 @@
+#pragma once
+#include <stdbool.h>
+#ifdef _WIN32
+#include <stdint.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+// Minimal native threads, shared by the game and the headless tools, which
+// do not link CSFML and so can not use sfThread.
+
+#pragma region Struct and Enum
+typedef struct Thread
+{
+#ifdef _WIN32
+	uintptr_t handle;
+#else
+	pthread_t handle;
+#endif
+	void (*function)(void*);
+	void* userData;
+}Thread;
+
+typedef struct Semaphore
+{
+#ifdef _WIN32
+	void* handle;
+#else
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	int count;
+#endif
+}Semaphore;
+#pragma endregion
+
+#pragma region Definition
+bool ThreadStart(Thread* const _thread, void (*_function)(void*), void* _userData);
+void ThreadWait(Thread* const _thread);
+int ThreadHardwareCount(void);
+void ThreadYield(void);
+
+bool SemaphoreCreate(Semaphore* const _semaphore);
+void SemaphoreDestroy(Semaphore* const _semaphore);
+void SemaphorePost(Semaphore* const _semaphore, int _count);
+void SemaphoreWait(Semaphore* const _semaphore);
+#pragma endregion
@@ -0,0 +1,39 @@
+#ifndef _WIN32
+// clock_gettime is POSIX, strict C modes hide it otherwise
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include "Timer.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int64_t TimerTicks(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (int64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+#endif
+}
+
+int64_t TimerFrequency(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return frequency.QuadPart;
+#else
+	return 1000000000;
+#endif
+}
+
+double TimerNow(void)
+{
+	return (double)TimerTicks() / TimerFrequency();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+
+// Monotonic wall clock for tools and worker threads, which have no sfClock.
+// CPU time (clock()) adds up over threads and can not time parallel work.
+
+#pragma region Definition
+int64_t TimerTicks(void);
+int64_t TimerFrequency(void);
+double TimerNow(void);
+#pragma endregion
@@ -0,0 +1,185 @@
+#include "Atomic.h"
+#include "Track.h"
+
+typedef struct TrackObject
+{
+	const void* object;
+	int site;
+}TrackObject;
+
+static volatile int32_t isRunning;
+// Creates come from the main thread, the render thread and the loader
+static volatile int32_t lock;
+static bool isSteady;
+static TrackCount counts[TRACK_TYPE_COUNT];
+static TrackSite sites[TRACK_MAX_SITES];
+static int siteCount;
+// Only the live ones, a destroyed object leaves its slot to the last one
+static TrackObject objects[TRACK_MAX_OBJECTS];
+static int objectCount;
+// Creates that did not fit, their destroy is then ignored too
+static int untrackedCount;
+
+static const char* typeNames[TRACK_TYPE_COUNT] = { "sprite", "texture", "text", "font", "sound buffer", "sound", "music", "clock" };
+
+static void Lock(void)
+{
+	while (!AtomicCompareExchange32(&lock, 0, 1))
+	{
+		AtomicPause();
+	}
+}
+
+static void Unlock(void)
+{
+	AtomicStore32(&lock, 0);
+}
+
+static int FindSite(TrackType _type, const char* _function, int _line)
+{
+	for (int i = 0; i < siteCount; i++)
+	{
+		if (sites[i].line == _line && sites[i].type == _type && sites[i].function == _function)
+		{
+			return i;
+		}
+	}
+	if (siteCount == TRACK_MAX_SITES)
+	{
+		return -1;
+	}
+	sites[siteCount] = (TrackSite){ _type, _function, _line, 0, 0, 0 };
+	return siteCount++;
+}
+
+void TrackStart(void)
+{
+	AtomicStore32(&isRunning, 1);
+}
+
+bool TrackIsRunning(void)
+{
+	return AtomicLoad32(&isRunning) != 0;
+}
+
+void* TrackCreate(TrackType _type, void* _object, const char* _function, int _line)
+{
+	if (!AtomicLoad32(&isRunning) || !_object)
+	{
+		return _object;
+	}
+
+	Lock();
+	int site = FindSite(_type, _function, _line);
+	if (site < 0 || objectCount == TRACK_MAX_OBJECTS)
+	{
+		untrackedCount++;
+		Unlock();
+		return _object;
+	}
+	objects[objectCount++] = (TrackObject){ _object, site };
+	sites[site].live++;
+	sites[site].created++;
+	if (isSteady)
+	{
+		sites[site].steadyCreated++;
+	}
+	TrackCount* count = &counts[_type];
+	count->live++;
+	count->created++;
+	count->frameCreated++;
+	if (count->live > count->peak)
+	{
+		count->peak = count->live;
+	}
+	Unlock();
+	return _object;
+}
+
+void TrackDestroy(TrackType _type, const void* _object)
+{
+	if (!AtomicLoad32(&isRunning) || !_object)
+	{
+		return;
+	}
+
+	Lock();
+	for (int i = 0; i < objectCount; i++)
+	{
+		if (objects[i].object == _object)
+		{
+			sites[objects[i].site].live--;
+			counts[_type].live--;
+			counts[_type].frameDestroyed++;
+			objects[i] = objects[--objectCount];
+			break;
+		}
+	}
+	Unlock();
+}
+
+void TrackEndFrame(void)
+{
+	if (!AtomicLoad32(&isRunning))
+	{
+		return;
+	}
+
+	Lock();
+	for (int i = 0; i < TRACK_TYPE_COUNT; i++)
+	{
+		TrackCount* count = &counts[i];
+		int churn = count->frameCreated + count->frameDestroyed;
+		if (churn)
+		{
+			count->churnFrames++;
+		}
+		if (churn > count->maxChurn)
+		{
+			count->maxChurn = churn;
+		}
+		count->frameCreated = 0;
+		count->frameDestroyed = 0;
+	}
+	Unlock();
+}
+
+void TrackSetSteady(bool _isSteady)
+{
+	Lock();
+	isSteady = _isSteady;
+	Unlock();
+}
+
+bool TrackReport(FILE* _file)
+{
+	Lock();
+	fprintf(_file, "%-14s %6s %6s %8s %10s %14s\n", "object", "live", "peak", "created", "max churn", "churned frames");
+	for (int i = 0; i < TRACK_TYPE_COUNT; i++)
+	{
+		const TrackCount* count = &counts[i];
+		fprintf(_file, "%-14s %6d %6d %8d %10d %14d\n", typeNames[i], count->live, count->peak, count->created, count->maxChurn, count->churnFrames);
+	}
+
+	bool isClean = true;
+	for (int i = 0; i < siteCount; i++)
+	{
+		const TrackSite* site = &sites[i];
+		if (site->live)
+		{
+			fprintf(_file, "leak: %d %s created in %s line %d\n", site->live, typeNames[site->type], site->function, site->line);
+			isClean = false;
+		}
+		if (site->steadyCreated)
+		{
+			fprintf(_file, "steady state: %d %s created in %s line %d\n", site->steadyCreated, typeNames[site->type], site->function, site->line);
+			isClean = false;
+		}
+	}
+	if (untrackedCount)
+	{
+		fprintf(_file, "%d objects were not tracked, raise TRACK_MAX_OBJECTS or TRACK_MAX_SITES\n", untrackedCount);
+	}
+	Unlock();
+	return isClean;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdbool.h>
+#include <stdio.h>
+
+// CSFML object lifetime tracking: tracked creates and destroys are counted
+// per type and per creation site, with the peak and the churn of every
+// frame, so leaks and objects made during gameplay show up in a report.
+// Until TrackStart a tracked call costs one load and one branch; build with
+// TRACK_ENABLED 0 to remove the tracking entirely.
+
+#pragma region Define
+#ifndef TRACK_ENABLED
+#define TRACK_ENABLED 1
+#endif
+
+#define TRACK_MAX_OBJECTS 4096
+#define TRACK_MAX_SITES 128
+
+// TRACK_CREATE evaluates to the object, TRACK_DESTROY evaluates it twice
+#if TRACK_ENABLED
+#define TRACK_CREATE(_type, _object) TrackCreate(_type, _object, __func__, __LINE__)
+#define TRACK_DESTROY(_type, _destroy, _object) (TrackDestroy(_type, _object), _destroy(_object))
+#else
+#define TRACK_CREATE(_type, _object) ((void)(_type), (_object))
+#define TRACK_DESTROY(_type, _destroy, _object) ((void)(_type), _destroy(_object))
+#endif
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum TrackType
+{
+	TRACK_SPRITE,
+	TRACK_TEXTURE,
+	TRACK_TEXT,
+	TRACK_FONT,
+	TRACK_SOUND_BUFFER,
+	TRACK_SOUND,
+	TRACK_MUSIC,
+	TRACK_CLOCK,
+	TRACK_TYPE_COUNT,
+}TrackType;
+
+typedef struct TrackSite
+{
+	TrackType type;
+	// __func__ and __LINE__ of the create
+	const char* function;
+	int line;
+	int live;
+	int created;
+	// Created while the steady state was set
+	int steadyCreated;
+}TrackSite;
+
+typedef struct TrackCount
+{
+	int live;
+	int peak;
+	int created;
+	int frameCreated;
+	int frameDestroyed;
+	// Creates and destroys of the busiest frame, and how many frames had any
+	int maxChurn;
+	int churnFrames;
+}TrackCount;
+#pragma endregion
+
+#pragma region Definition
+// Before the first tracked create: objects created earlier are not known when they are destroyed
+void TrackStart(void);
+bool TrackIsRunning(void);
+
+// Any thread. NULL objects are ignored.
+void* TrackCreate(TrackType _type, void* _object, const char* _function, int _line);
+void TrackDestroy(TrackType _type, const void* _object);
+// Closes the churn of the frame, once per main loop iteration
+void TrackEndFrame(void);
+// Between the end of loading and the cleanup: gameplay must not create anything
+void TrackSetSteady(bool _isSteady);
+
+// Counts per type, objects still alive by creation site and steady state creations.
+// False if anything leaked or was created in the steady state.
+bool TrackReport(FILE* _file);
+#pragma endregion
@@ -0,0 +1,39 @@
+#include "TripleBuffer.h"
+#include "Atomic.h"
+
+void TripleBufferInit(TripleBuffer* const _buffer, void* _slot0, void* _slot1, void* _slot2)
+{
+	_buffer->slots[0] = _slot0;
+	_buffer->slots[1] = _slot1;
+	_buffer->slots[2] = _slot2;
+	_buffer->back = 0;
+	_buffer->middle = 1;
+	_buffer->front = 2;
+}
+
+void* TripleBufferWriteSlot(TripleBuffer* const _buffer)
+{
+	return _buffer->slots[_buffer->back];
+}
+
+void TripleBufferPublish(TripleBuffer* const _buffer)
+{
+	// The slot the reader did not take yet (if any) becomes the next one to fill
+	int32_t previous = AtomicExchange32(&_buffer->middle, _buffer->back | TRIPLE_BUFFER_FRESH);
+	_buffer->back = previous & TRIPLE_BUFFER_INDEX;
+}
+
+void* TripleBufferRead(TripleBuffer* const _buffer, bool* const _isNew)
+{
+	bool isNew = (AtomicLoad32(&_buffer->middle) & TRIPLE_BUFFER_FRESH) != 0;
+	if (isNew)
+	{
+		int32_t previous = AtomicExchange32(&_buffer->middle, _buffer->front);
+		_buffer->front = previous & TRIPLE_BUFFER_INDEX;
+	}
+	if (_isNew)
+	{
+		*_isNew = isNew;
+	}
+	return _buffer->slots[_buffer->front];
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lock-free single writer, single reader triple buffer: the writer always
+// has a free slot to fill and the reader always gets the latest complete
+// one, so neither side ever waits for the other. Slots are swapped, never copied.
+
+#pragma region Define
+#define TRIPLE_BUFFER_FRESH 4
+#define TRIPLE_BUFFER_INDEX 3
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct TripleBuffer
+{
+	void* slots[3];
+	// Only touched by the writer and by the reader respectively
+	int back;
+	int front;
+	// Latest published slot, plus TRIPLE_BUFFER_FRESH until the reader takes it
+	volatile int32_t middle;
+}TripleBuffer;
+#pragma endregion
+
+#pragma region Definition
+// The three slots must hold a valid state before the reader starts
+void TripleBufferInit(TripleBuffer* const _buffer, void* _slot0, void* _slot1, void* _slot2);
+void* TripleBufferWriteSlot(TripleBuffer* const _buffer);
+void TripleBufferPublish(TripleBuffer* const _buffer);
+void* TripleBufferRead(TripleBuffer* const _buffer, bool* const _isNew);
+#pragma endregion
@@ -1,7 +1,31 @@
 ﻿#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <SFML/Graphics.h>
 #include <SFML/Audio.h>
+#include "Simulation.h"
+#include "Replay.h"
+#include "File.h"
+#include "Job.h"
+#include "Thread.h"
+#include "TripleBuffer.h"
+#include "Atomic.h"
+#include "Input.h"
+#include "Timer.h"
+#include "Latency.h"
+#include "Solver.h"
+#include "Profile.h"
+#include "Overlay.h"
+#include "Digits.h"
+#include "SpriteBatch.h"
+#include "AssetPack.h"
+#include "Atlas.h"
+#include "Layer.h"
+#include "Loader.h"
+#include "Resource.h"
+#include "Track.h"
+#include "Startup.h"
 
 #pragma region Define
 #define SCREEN_WIDTH 540
@@ -10,9 +34,27 @@
 #define MAX_FPS 60
 #define SCREEN_NAME "Timberman"
 
+#define SIM_TICK_RATE 120
+#define MAX_TICKS_PER_FRAME 8
+// A frame only has a few phases, more workers would just sleep
+#define JOB_WORKER_COUNT 4
+
+// Synthetic latency test: seconds between two injected chops (jittered by +-50%),
+// and how long to wait for the last one to reach the screen
+#define LATENCY_TEST_INTERVAL 0.2f
+#define LATENCY_TEST_SETTLE 0.5f
+
+#define DEFAULT_TRACE_PATH "trace.json"
+
+#define SCORE_CHARACTER_SIZE 35
+
+// Next to the executable, written by AssetTool: AssetTool bundle Assets Assets.pack Atlas Fonts Musics Sounds
+#define ASSET_PACK_FILE "Assets.pack"
+#define ASSET_PACK_DIRECTORIES "Atlas Fonts Musics Sounds"
+// Written by AssetTool: AssetTool pack Assets/Sprites Assets/Atlas/Sprites.atlas
+#define ATLAS_ENTRY "Atlas/Sprites.atlas"
+
 #define GROUND SCREEN_HEIGHT * 0.82f 
-#define MAX_LIFE_TIME 10
-#define BASE_POSITION -1
 #pragma endregion
 
 #pragma region Struct and Enum
@@ -23,24 +65,131 @@ typedef enum GameState
 	GAME_OVER,
 }GameState;
 
-typedef enum TruncType
+// What changed in the HUD since it was last laid out
+typedef enum HudDirty
+{
+	HUD_DIRTY_SCORE = 1 << 0,
+	HUD_DIRTY_MAX_SCORE = 1 << 1,
+	HUD_DIRTY_BUTTON = 1 << 2,
+	HUD_DIRTY_LIFE = 1 << 3,
+	HUD_DIRTY_ALL = 0xF,
+}HudDirty;
+
+// Back to front, sprites of one layer must not overlap
+typedef enum DrawLayer
+{
+	LAYER_BACKGROUND,
+	LAYER_TREE,
+	LAYER_PLAYER,
+	LAYER_HUD,
+	LAYER_HUD_FRONT,
+}DrawLayer;
+
+// Everything the render thread needs from the simulation, copied whole every update
+typedef struct RenderState
+{
+	GameState gameState;
+	TruncType trunc[MAX_TRUNC_COUNT];
+	int truncCount;
+	uint32_t session;
+	int score;
+	int maxScore;
+	struct Animation* playerAnimation;
+	int playerFrame;
+	int dir;
+	sfBool isDead;
+	float lifeFraction;
+	sfBool isButtonHovered;
+	sfBool isDebug;
+	uint32_t staticVersion;
+	// Latest applied chop and its TimerTicks stamps, inputTime is 0 for replayed chops
+	uint32_t chopSequence;
+	int64_t chopInputTime;
+	int64_t chopApplyTime;
+	// Seconds the main thread spent in the ticks of the last update
+	float simulateTime;
+}RenderState;
+
+// The window, or the offscreen texture the latency test reads back
+typedef struct RenderTarget
+{
+	sfRenderWindow* window;
+	sfRenderTexture* texture;
+	// Since the last ResetTargetStats, for the overlay
+	int drawCount;
+	int textureSwitchCount;
+	const sfTexture* lastTexture;
+}RenderTarget;
+
+typedef struct Renderer
+{
+	Thread thread;
+	TripleBuffer states;
+	RenderState slots[3];
+	volatile int32_t isRunning;
+	sfClock* clock;
+	sfRenderWindow* renderWindow;
+	struct GameData* gameData;
+	RenderTarget target;
+	Latency* latency;
+	uint32_t shownChopSequence;
+	// Latency test only: the frame is drawn offscreen with a marker pixel, then copied to the window
+	sfBool isOffscreen;
+	sfSprite* offscreenSprite;
+	sfRectangleShape* marker;
+	int markerMismatchCount;
+	Overlay overlay;
+	SpriteBatch batch;
+	// Background and stump, they cover the whole screen
+	StaticLayer background;
+	// TimerTicks once the first frame is displayed, 0 before
+	volatile int64_t firstFrameTime;
+}Renderer;
+
+typedef struct LatencyTest
 {
-	NORMAL,
-	NORMAL2,
-	LEFT,
-	RIGHT,
-}TruncType;
+	sfBool isActive;
+	// Chops still to inject
+	int remaining;
+	int64_t nextTime;
+	int64_t endTime;
+	Random random;
+}LatencyTest;
 
 typedef struct MainData
 {
 	sfRenderWindow* renderWindow;
 	sfClock* clock;
+	int tickRate;
+	float accumulator;
+	uint64_t seed;
+	const char* replayPath;
+	const char* recordPrefix;
+	JobSystem jobs;
+	Renderer renderer;
+	InputSampler input;
+	Latency latency;
+	const char* latencyPath;
+	LatencyTest latencyTest;
+	// Written when a capture ends, from the P key or at exit with --profile
+	const char* tracePath;
+	// Startup timings are written there once the menu is shown, then the game quits
+	const char* startupPath;
+	// TimerTicks the timings start from, the launch time in the benchmark
+	int64_t startupOrigin;
+	// Counts the CSFML objects, reports leaks at exit and fails if gameplay creates any
+	sfBool isTrackingObjects;
+	sfBool isRunning;
 }MainData;
 
 typedef struct Animation
 {
-	sfTexture* texture;
+	// The frames and their count come from the atlas
+	const Atlas* atlas;
+	const AtlasSprite* sheet;
 	sfSprite* sprite;
+	// Render thread side: the frame the sprite was last cut for
+	int shownFrame;
 	int frameCount;
 	float frameRate;
 	int currentFrame;
@@ -60,8 +209,6 @@ typedef struct Player
 {
 	PlayerAnimation animation;
 	float animationTime;
-	int dir;
-	sfBool dead;
 	sfBool isCutting;
 	sfSoundBuffer* soundBufferCutting;
 	sfSoundBuffer* soundBufferDeath;
@@ -76,164 +223,455 @@ typedef struct Color
 typedef struct HUD
 {
 	sfFont* font;
-	sfFont* fontScore;
-	sfText* fpsText;
-	sfText* scoreText;
-	sfText* maxScoreText;
+	DigitFont digits;
+	DigitText scoreText;
+	DigitText maxScoreText;
+	sfVector2f maxScorePosition;
 	sfSprite* title;
 	sfSprite* button;
 	sfSprite* gameOver;
 	sfSprite* timeContainer;
 	sfSprite* timeBar;
+	// Written by the mouse events on the main thread
 	sfBool isColiding;
+	// The button never moves, hit tests must not touch the sprite the render thread draws
+	sfFloatRect buttonRect;
+	// Render thread side: the values the texts and sprites were last laid out for
+	sfBool isLaidOut;
+	int shownScore;
+	int shownMaxScore;
+	GameState shownState;
+	sfBool shownHover;
+	int shownLifeWidth;
+	unsigned int timeBarWidth;
 }HUD;
 
 typedef struct TrunKTexture
 {
-	sfTexture* trunc1;
-	sfTexture* trunc2;
-	sfTexture* branchLeft;
-	sfTexture* branchRight;
+	const Atlas* atlas;
+	const AtlasSprite* trunc1;
+	const AtlasSprite* trunc2;
+	const AtlasSprite* branchLeft;
+	const AtlasSprite* branchRight;
 }TrunKTexture;
 
 typedef struct Level
 {
 	sfSprite* background;
 	sfSprite* baseLog;
-	sfSprite* trunc1;
-	sfSprite* trunc2;
-	sfSprite* trunc3;
-	sfSprite* trunc4;
-	sfSprite* trunc5;
-	sfSprite* trunc6;
+	sfSprite* trunc[MAX_TRUNC_COUNT];
+	int truncCount;
+	int truncHead;
+	sfVector2f truncBase;
+	float truncHeight;
+	// Session and score the trunk sprites were last textured for
+	uint32_t truncSession;
+	int truncScore;
 	TrunKTexture texture;
 	sfMusic* music;
+	// The music streams out of the pack mapping, CSFML keeps a pointer to it
+	AssetStream musicStream;
 }Level;
 
 typedef struct Game
 {
 	Player player;
 	Level level;
-	sfBool isGameStarted;
-	float lifeTime;
-	int score;
+	Simulation sim;
+	SimAction pendingAction;
+	uint64_t seed;
+	int tickRate;
 	int maxScore;
+	Replay replay;
+	ReplayPlayer replayPlayer;
+	sfBool isReplaying;
+	const char* recordPrefix;
+	// Bumped by every GameBeginSession so the renderer knows the trunk was regenerated
+	uint32_t session;
+	// TimerTicks of GameStart, the press that started the game must not chop too
+	int64_t startTime;
+	// Sampling time of pendingAction, then of the last chop the simulation applied
+	int64_t pendingTime;
+	uint32_t chopSequence;
+	int64_t chopInputTime;
+	int64_t chopApplyTime;
 }Game;
 
 typedef struct GameData
 {
+	// Mapped for the whole run, fonts and music read from it long after loading
+	AssetPack pack;
+	// Every texture, font, sound buffer and the music data, each shared by its users
+	ResourceCache resources;
+	Atlas atlas;
 	HUD hud;
 	Color color;
 	Game game;
 	GameState gameState;
 	sfBool isDebug;
+	// Bumped whenever what the static layer shows changes, the render thread then draws it again
+	uint32_t staticVersion;
 }GameData;
+
+// Shared by the steps of one frame
+typedef struct Frame
+{
+	MainData* mainData;
+	GameData* gameData;
+	float dt;
+	// TimerTicks when dt was measured
+	int64_t time;
+	float simulateTime;
+}Frame;
+
+// Shared by the phases of one rendered frame
+typedef struct RenderFrame
+{
+	GameData* gameData;
+	const RenderState* state;
+	float dt;
+}RenderFrame;
 #pragma endregion
 
 #pragma region Definition
+void ParseArguments(int _argc, char** _argv, MainData* const _mainData);
 void Load(MainData* const _mainData, GameData* const _gameData);
 
-void PollEvent(sfRenderWindow* _renderWindow, GameData* const _gameData);
-void OnKeyPressed(sfKeyEvent _key, sfRenderWindow* _renderWindow, GameData* const _gameData);
-void OnMouseButtonPressed(sfMouseButtonEvent _button);
-void OnMouseMoved(void);
+void PollEvent(MainData* const _mainData, GameData* const _gameData);
+void OnKeyPressed(sfKeyEvent _key, MainData* const _mainData, GameData* const _gameData);
+void OnMouseButtonPressed(sfMouseButtonEvent _button, GameData* const _gameData);
+void OnMouseMoved(sfMouseMoveEvent _move, GameData* const _gameData);
 
 void Update(MainData* const _mainData, GameData* const _gameData);
-void Draw(sfRenderWindow* const _renderWindow, GameData* const _gameData);
+void UpdateSimulation(Frame* const _frame);
+void ApplyInput(InputSampler* const _input, GameData* const _gameData, int64_t _tickEnd);
+void PublishRenderState(const Frame* const _frame);
+void WaitNextTick(MainData* const _mainData);
+void Draw(RenderTarget* const _target, SpriteBatch* const _batch, StaticLayer* const _background, GameData* const _gameData, const RenderState* const _state);
+sfBool DrawBackground(RenderTarget* const _target, SpriteBatch* const _batch, StaticLayer* const _background, GameData* const _gameData, const RenderState* const _state);
 void Cleanup(MainData* const _mainData, GameData* const _gameData);
 
+void TargetClear(RenderTarget* const _target, sfColor _color);
+void TargetDrawBatch(RenderTarget* const _target, const SpriteBatch* const _batch);
+void TargetDrawLayer(RenderTarget* const _target, const StaticLayer* const _layer);
+sfVector2u TargetGetSize(const RenderTarget* const _target);
+void TargetDrawText(RenderTarget* const _target, const sfText* const _text);
+void TargetDrawRectangle(RenderTarget* const _target, const sfRectangleShape* const _rectangle);
+void TargetDrawVertexArray(RenderTarget* const _target, const sfVertexArray* const _vertices, const sfTexture* const _texture);
+void CountTexture(RenderTarget* const _target, const sfTexture* const _texture);
+void ResetTargetStats(RenderTarget* const _target);
+void TargetDisplay(RenderTarget* const _target);
+
+void StartLatencyTest(MainData* const _mainData, int _chopCount);
+void InjectInput(MainData* const _mainData, GameData* const _gameData);
+sfBool ReportLatency(MainData* const _mainData);
+
+void ToggleProfile(MainData* const _mainData);
+void CheckStartup(MainData* const _mainData);
+
+void StartRenderer(MainData* const _mainData, GameData* const _gameData);
+void StopRenderer(MainData* const _mainData);
+void RenderThread(void* _renderer);
+void FillRenderState(RenderState* const _state, const GameData* const _gameData);
+void RenderHudPhase(const RenderFrame* const _frame);
+void RenderLevelPhase(const RenderFrame* const _frame);
+void RenderPlayerPhase(const RenderFrame* const _frame);
+void CreateOffscreen(Renderer* const _renderer);
+void DestroyOffscreen(Renderer* const _renderer);
+void PresentFrame(Renderer* const _renderer, const RenderState* const _state);
+void DrawOverlay(Renderer* const _renderer, float _dt);
+sfColor MarkerColor(uint32_t _chopSequence);
+
 void Reset(GameData* const _gameData);
 
 void LoadScreen(MainData* const _mainData);
-void LoadHud(HUD* const _hud);
-void UpdateHud(float const _dt, GameData* const _gameData);
-void CleanupHud(HUD* const _hud);
-
-void UpdateText(sfText* const _text, int _value);
-void CreateSprite(sfSprite** const _sprite, sfVector2f position, const char* _filepath);
-
-void SetupAnimation(Animation* _anim, sfTexture** const _texture, int _frameCount, float _frameRate, sfBool _isLooping);
+void DrawLoadScreen(sfRenderWindow* const _renderWindow, float _progress);
+sfBool WaitLoader(MainData* const _mainData, const Loader* const _loader);
+sfBool LoadAtlas(Atlas* const _atlas, const AssetPack* const _pack);
+sfBool LoadAtlasPages(Atlas* const _atlas, ResourceCache* const _resources);
+void ReleaseAtlasPages(Atlas* const _atlas, ResourceCache* const _resources);
+sfBool CheckResource(const ResourceCache* const _resources, const char* _name, const void* _resource);
+void LoadHud(HUD* const _hud, const Atlas* const _atlas, ResourceCache* const _resources);
+void UpdateHud(float const _dt, HUD* const _hud, const RenderState* const _state);
+void CleanupHud(HUD* const _hud, ResourceCache* const _resources);
+
+sfVector2i CreateSprite(sfSprite** const _sprite, sfVector2f position, const Atlas* const _atlas, const char* _name);
+
+void SetupAnimation(Animation* _anim, const Atlas* const _atlas, const char* _name, float _frameRate, sfBool _isLooping);
 void AnimateSprite(Animation* _anim, float const _dt);
+void SetAnimationFrame(Animation* const _anim, int _frame);
 sfBool AnimIsFinished(Animation* const _anim);
 void cleanupAnimation(Animation* animation);
 
-void LoadGame(Game* const _game);
-void GameOnKeyPressed(sfKeyEvent _key, Game* const _game);
-void UpdateButton(float _dt, sfRenderWindow* const _renderWindow, GameData* const _gameData);
-void UpdateGame(float _dt, Game* const _game, HUD* const _hud, GameState _gameState);
-void DrawButton(sfRenderWindow* const _renderWindow, HUD* const _hud);
-
-void LoadLevel(Level* const _level);
-void DrawLevel(sfRenderWindow* const _renderWindow, Level* const _level);
-void CleanupLevel(Level* const _level);
+void LoadGame(Game* const _game, int _truncCount, uint64_t _seed, const Atlas* const _atlas, ResourceCache* const _resources);
+void GameBeginSession(Game* const _game);
+void GameEndSession(Game* const _game);
+void GameStart(Game* const _game);
+void SetButtonHover(HUD* const _hud, int _x, int _y);
+void UpdateGame(float _dt, Game* const _game, GameState _gameState);
+void DrawButton(SpriteBatch* const _batch, HUD* const _hud);
 
-void CheckPlayerCollide(Level* const _level, Player* const _player);
+void LoadLevel(Level* const _level, int _truncCount, const Atlas* const _atlas, ResourceCache* const _resources);
+void DrawLevelStatic(SpriteBatch* const _batch, Level* const _level);
+void DrawLevel(SpriteBatch* const _batch, Level* const _level, const RenderState* const _state);
+void CleanupLevel(Level* const _level, ResourceCache* const _resources);
 
-void UpdateLifeBar(float _dt, Game* const _game, HUD* const _hud, sfBool _isStarted);
+void GameChop(Game* const _game, SimAction _action, int64_t _time);
+void UpdateLifeBar(HUD* const _hud, int _width);
 
 void CreateTrunc(sfSprite** const _trunc, sfVector2f position);
 void AsigneTruncTexture(sfSprite** const _trunc, TruncType _truncType, TrunKTexture* _texture);
-void UpdateTruncTexture(Level* const _level);
-
-void LoadPlayer(Player* const _player);
-void LoadPlayerAnimations(Player* const _player);
-void PlayerUpdateMovement(Player* const _player);
-void PlayerUpdateAnimation(float _dt, Player* const _player);
-void DrawPlayer(sfRenderWindow* const _renderWindow, Player* const _player);
-void CleanupPlayer(Player* const _player);
+void UpdateTrunc(Level* const _level, const RenderState* const _state);
+void UpdateTruncTexture(Level* const _level, const RenderState* const _state, int _chopCount);
+void ResetTruncTexture(Level* const _level, const RenderState* const _state);
+
+void LoadPlayer(Player* const _player, const Atlas* const _atlas, ResourceCache* const _resources);
+void LoadPlayerAnimations(Player* const _player, const Atlas* const _atlas);
+void PlayerUpdateMovement(Player* const _player, const RenderState* const _state);
+void PlayerUpdateAnimation(float _dt, Player* const _player, const Simulation* const _sim);
+void DrawPlayer(SpriteBatch* const _batch, Animation* const _animation);
+void CleanupPlayer(Player* const _player, ResourceCache* const _resources);
 #pragma endregion
 
 #pragma region Core
-int main(void)
+int main(int argc, char** argv)
 {
+	int64_t mainTime = TimerTicks();
 	MainData mainData = { 0 };
 	GameData gameData = { 0 };
+	ProfileSetThreadName("main");
+	ParseArguments(argc, argv, &mainData);
+	if (mainData.isTrackingObjects)
+	{
+		TrackStart();
+	}
+	if (mainData.startupPath)
+	{
+		StartupBegin(mainData.startupOrigin ? mainData.startupOrigin : mainTime);
+		StartupMark(STARTUP_MAIN, mainTime);
+	}
 	Load(&mainData, &gameData);
 
-	while (sfRenderWindow_isOpen(mainData.renderWindow))
+	while (mainData.isRunning)
 	{
-		PollEvent(mainData.renderWindow, &gameData);
+		PROFILE_BEGIN(PollEvent);
+		PollEvent(&mainData, &gameData);
+		if (mainData.latencyTest.isActive)
+		{
+			InjectInput(&mainData, &gameData);
+		}
+		PROFILE_END(PollEvent);
 
+		PROFILE_BEGIN(Update);
 		Update(&mainData, &gameData);
+		PROFILE_END(Update);
+		if (mainData.startupPath)
+		{
+			CheckStartup(&mainData);
+		}
+		// Everything is created once the first frame is shown, from then on gameplay only reuses it
+		if (AtomicLoad64(&mainData.renderer.firstFrameTime))
+		{
+			TrackSetSteady(true);
+		}
+		TrackEndFrame();
 
-		Draw(mainData.renderWindow, &gameData);
+		PROFILE_BEGIN(WaitNextTick);
+		WaitNextTick(&mainData);
+		PROFILE_END(WaitNextTick);
 	}
 
+	TrackSetSteady(false);
 	Cleanup(&mainData, &gameData);
+	if (ProfileIsRunning())
+	{
+		ToggleProfile(&mainData);
+	}
+	ProfileShutdown();
+
+	sfBool isLatencyValid = ReportLatency(&mainData);
+	sfBool isTrackClean = !TrackIsRunning() || TrackReport(stdout);
+	return isLatencyValid && isTrackClean ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-	return EXIT_SUCCESS;
+void ParseArguments(int _argc, char** _argv, MainData* const _mainData)
+{
+	_mainData->tickRate = SIM_TICK_RATE;
+	_mainData->seed = (uint64_t)time(NULL);
+	for (int i = 1; i < _argc; i++)
+	{
+		if (strcmp(_argv[i], "--tick-rate") == 0 && i + 1 < _argc)
+		{
+			int tickRate = atoi(_argv[++i]);
+			if (tickRate > 0)
+			{
+				_mainData->tickRate = tickRate;
+			}
+		}
+		else if (strcmp(_argv[i], "--seed") == 0 && i + 1 < _argc)
+		{
+			_mainData->seed = strtoull(_argv[++i], NULL, 10);
+		}
+		else if (strcmp(_argv[i], "--replay") == 0 && i + 1 < _argc)
+		{
+			_mainData->replayPath = _argv[++i];
+		}
+		else if (strcmp(_argv[i], "--record") == 0 && i + 1 < _argc)
+		{
+			_mainData->recordPrefix = _argv[++i];
+		}
+		else if (strcmp(_argv[i], "--latency-out") == 0 && i + 1 < _argc)
+		{
+			_mainData->latencyPath = _argv[++i];
+		}
+		else if (strcmp(_argv[i], "--latency-test") == 0 && i + 1 < _argc)
+		{
+			StartLatencyTest(_mainData, atoi(_argv[++i]));
+		}
+		else if (strcmp(_argv[i], "--profile") == 0 && i + 1 < _argc)
+		{
+			// Captures the whole run, loading included
+			_mainData->tracePath = _argv[++i];
+			ProfileStart();
+		}
+		else if (strcmp(_argv[i], "--startup-report") == 0 && i + 1 < _argc)
+		{
+			_mainData->startupPath = _argv[++i];
+		}
+		else if (strcmp(_argv[i], "--startup-origin") == 0 && i + 1 < _argc)
+		{
+			_mainData->startupOrigin = strtoll(_argv[++i], NULL, 10);
+		}
+		else if (strcmp(_argv[i], "--track-objects") == 0)
+		{
+			_mainData->isTrackingObjects = sfTrue;
+		}
+	}
 }
 
 void Load(MainData* const _mainData, GameData* const _gameData)
 {
+	// The window shows the progress before anything is read, the decoding then runs on the workers
 	LoadScreen(_mainData);
-	LoadHud(&_gameData->hud);
-	LoadGame(&_gameData->game);
+	JobSystemCreate(&_mainData->jobs, JOB_WORKER_COUNT);
+	char packPath[ASSET_PACK_PATH_LENGTH];
+	AssetPackPath(packPath, sizeof(packPath), ASSET_PACK_FILE);
+	if (!AssetPackOpen(&_gameData->pack, packPath))
+	{
+		printf("Could not open %s, run AssetTool bundle Assets %s %s\n", packPath, ASSET_PACK_FILE, ASSET_PACK_DIRECTORIES);
+		exit(EXIT_FAILURE);
+	}
+	ResourceCacheCreate(&_gameData->resources, &_gameData->pack);
+	if (!LoadAtlas(&_gameData->atlas, &_gameData->pack))
+	{
+		printf("Could not load %s, run AssetTool pack Assets/Sprites Assets/%s then bundle the assets again\n", ATLAS_ENTRY, ATLAS_ENTRY);
+		exit(EXIT_FAILURE);
+	}
+
+	Loader loader;
+	char pages[ATLAS_MAX_PAGES][ATLAS_PATH_LENGTH];
+	LoaderCreate(&loader, &_mainData->jobs, &_gameData->pack);
+	for (int i = 0; i < _gameData->atlas.pageCount; i++)
+	{
+		AtlasPagePath(&_gameData->atlas, ATLAS_ENTRY, i, pages[i], sizeof(pages[i]));
+		LoaderAdd(&loader, pages[i], LOAD_IMAGE);
+	}
+	LoaderAdd(&loader, "Fonts/arial.ttf", LOAD_FONT);
+	LoaderAdd(&loader, "Fonts/KomikaParch.ttf", LOAD_FONT);
+	LoaderAdd(&loader, "Sounds/Cut.ogg", LOAD_SOUND);
+	LoaderAdd(&loader, "Sounds/Death.ogg", LOAD_SOUND);
+	LoaderAdd(&loader, "Musics/Theme.ogg", LOAD_DATA);
+	LoaderStart(&loader);
+	sfBool isClosed = WaitLoader(_mainData, &loader);
+	for (int i = 0; i < loader.taskCount; i++)
+	{
+		StartupAddAsset(loader.tasks[i].name, loader.tasks[i].ioTime, loader.tasks[i].decodeTime, 0);
+	}
+
+	// The cache takes over what the workers decoded
+	ResourceCacheSetLoader(&_gameData->resources, &loader);
+	if (!LoadAtlasPages(&_gameData->atlas, &_gameData->resources))
+	{
+		printf("Could not load the pages of %s\n", ATLAS_ENTRY);
+		exit(EXIT_FAILURE);
+	}
+	LoadHud(&_gameData->hud, &_gameData->atlas, &_gameData->resources);
+
+	Game* const game = &_gameData->game;
+	int truncCount = DEFAULT_TRUNC_COUNT;
+	uint64_t seed = _mainData->seed;
+	game->recordPrefix = _mainData->recordPrefix;
+	if (_mainData->replayPath)
+	{
+		if (ReplayLoad(&game->replay, _mainData->replayPath))
+		{
+			// The replay dictates everything that changes the simulation result
+			game->isReplaying = sfTrue;
+			game->recordPrefix = NULL;
+			_mainData->tickRate = game->replay.tickRate;
+			truncCount = game->replay.height;
+			seed = game->replay.seed;
+		}
+		else
+		{
+			printf("Could not read replay %s\n", _mainData->replayPath);
+		}
+	}
+	game->tickRate = _mainData->tickRate;
+	LoadGame(game, truncCount, seed, &_gameData->atlas, &_gameData->resources);
+	ResourceCacheSetLoader(&_gameData->resources, NULL);
+	LoaderDestroy(&loader);
 
 	_gameData->gameState = MENU;
 	_gameData->isDebug = sfFalse;
 	_gameData->color.blueGrey = sfColor_fromRGB(119, 136, 153);
-	_mainData->clock = sfClock_create();
+	_mainData->clock = TRACK_CREATE(TRACK_CLOCK, sfClock_create());
+	StartupMark(STARTUP_LOADED, TimerTicks());
+	StartRenderer(_mainData, _gameData);
+	// Closing the window while loading quits once the loading is done, the jobs can not be stopped midway
+	if (isClosed)
+	{
+		_mainData->isRunning = sfFalse;
+	}
+	// The latency test feeds the input ring itself, real keys would disturb it
+	if (!_mainData->latencyTest.isActive && !InputStart(&_mainData->input))
+	{
+		printf("Could not start the input thread\n");
+	}
 }
 
-void PollEvent(sfRenderWindow* _renderWindow, GameData* const _gameData)
+void PollEvent(MainData* const _mainData, GameData* const _gameData)
 {
+	// Events stay on the thread that created the window, the window itself is closed in Cleanup
 	sfEvent event;
-	while (sfRenderWindow_pollEvent(_renderWindow, &event))
+	while (sfRenderWindow_pollEvent(_mainData->renderWindow, &event))
 	{
 		switch (event.type)
 		{
 		case sfEvtClosed:
-			sfRenderWindow_close(_renderWindow);
+			_mainData->isRunning = sfFalse;
 			break;
 		case sfEvtKeyPressed:
-			OnKeyPressed(event.key, _renderWindow, _gameData);
+			OnKeyPressed(event.key, _mainData, _gameData);
+			break;
+		case sfEvtLostFocus:
+			InputSetFocus(&_mainData->input, false);
+			break;
+		case sfEvtGainedFocus:
+			InputSetFocus(&_mainData->input, true);
 			break;
 		case sfEvtMouseButtonPressed:
-			OnMouseButtonPressed(event.mouseButton);
+			OnMouseButtonPressed(event.mouseButton, _gameData);
 			break;
 		case sfEvtMouseMoved:
-			OnMouseMoved();
+			OnMouseMoved(event.mouseMove, _gameData);
+			break;
+		case sfEvtMouseLeft:
+			_gameData->hud.isColiding = sfFalse;
+			break;
+		case sfEvtResized:
+			// The static layer is rendered again at the new resolution
+			_gameData->staticVersion++;
 			break;
 		default:
 			break;
@@ -241,18 +679,21 @@ void PollEvent(sfRenderWindow* _renderWindow, GameData* const _gameData)
 	}
 }
 
-void OnKeyPressed(sfKeyEvent _key, sfRenderWindow* _renderWindow, GameData* const _gameData)
+void OnKeyPressed(sfKeyEvent _key, MainData* const _mainData, GameData* const _gameData)
 {
 
 	switch (_key.code)
 	{
 	case sfKeyEscape:
-		sfRenderWindow_close(_renderWindow);
+		_mainData->isRunning = sfFalse;
 		break;
 
 	case sfKeyI:
 		_gameData->isDebug = !_gameData->isDebug;
 		break;
+	case sfKeyP:
+		ToggleProfile(_mainData);
+		break;
 	case sfKeySpace:
 		if (_gameData->gameState == GAME_OVER)
 		{
@@ -263,27 +704,52 @@ void OnKeyPressed(sfKeyEvent _key, sfRenderWindow* _renderWindow, GameData* cons
 		switch (_gameData->gameState)
 		{
 		case MENU:
-			_gameData->gameState = GAME;
-			_gameData->game.isGameStarted = sfTrue;
-			break;
-		case GAME:
-			GameOnKeyPressed(_key, &_gameData->game);
+			GameStart(&_gameData->game);
+			if (_gameData->game.sim.isStarted)
+			{
+				_gameData->gameState = GAME;
+			}
 			break;
 		default:
+			// Chops come from the input thread, see ApplyInput
 			break;
 		}
 		break;
 	}
 }
 
-void OnMouseMoved(void)
+void OnMouseMoved(sfMouseMoveEvent _move, GameData* const _gameData)
 {
+	SetButtonHover(&_gameData->hud, _move.x, _move.y);
 }
 
-void OnMouseButtonPressed(sfMouseButtonEvent _button)
+void OnMouseButtonPressed(sfMouseButtonEvent _button, GameData* const _gameData)
 {
+	HUD* const hud = &_gameData->hud;
+	Game* const game = &_gameData->game;
+	SetButtonHover(hud, _button.x, _button.y);
+
 	switch (_button.button)
 	{
+	case sfMouseLeft:
+		if (!hud->isColiding)
+		{
+			break;
+		}
+		if (_gameData->gameState == MENU)
+		{
+			GameStart(game);
+			if (game->sim.isStarted)
+			{
+				_gameData->gameState = GAME;
+				sfMusic_play(game->level.music);
+			}
+		}
+		else if (_gameData->gameState == GAME_OVER)
+		{
+			Reset(_gameData);
+		}
+		break;
 	default:
 		break;
 	}
@@ -291,161 +757,794 @@ void OnMouseButtonPressed(sfMouseButtonEvent _button)
 
 void Update(MainData* const _mainData, GameData* const _gameData)
 {
-	float dt = sfTime_asSeconds(sfClock_restart(_mainData->clock));
-	UpdateHud(dt, _gameData);
-	if (_gameData->gameState == MENU || _gameData->gameState == GAME_OVER)
+	Frame frame = { _mainData, _gameData, sfTime_asSeconds(sfClock_restart(_mainData->clock)), TimerTicks(), 0 };
+
+	// The snapshot is taken once the ticks are done, drawing happens on the render thread
+	UpdateSimulation(&frame);
+	PublishRenderState(&frame);
+}
+
+void UpdateSimulation(Frame* const _frame)
+{
+	PROFILE_BEGIN(Simulate);
+	MainData* const mainData = _frame->mainData;
+	GameData* const gameData = _frame->gameData;
+	int64_t start = TimerTicks();
+
+	// The simulation always advances by whole ticks so the result does not depend on the frame rate
+	float tickTime = 1.f / mainData->tickRate;
+	mainData->accumulator += _frame->dt;
+	int tickCount = 0;
+	while (mainData->accumulator >= tickTime && tickCount < MAX_TICKS_PER_FRAME)
+	{
+		// Presses are applied on the tick whose time span contains them
+		int64_t tickEnd = _frame->time - (int64_t)((mainData->accumulator - tickTime) * TimerFrequency());
+		ApplyInput(&mainData->input, gameData, tickEnd);
+
+		if (gameData->game.sim.dead)
+		{
+			gameData->gameState = GAME_OVER;
+		}
+		uint32_t chopSequence = gameData->game.chopSequence;
+		PROFILE_BEGIN(UpdateGame);
+		UpdateGame(tickTime, &gameData->game, gameData->gameState);
+		PROFILE_END(UpdateGame);
+		if (gameData->game.chopSequence != chopSequence && gameData->game.chopInputTime)
+		{
+			LatencyRecord(&mainData->latency, LATENCY_INPUT_TO_TICK, gameData->game.chopApplyTime - gameData->game.chopInputTime);
+		}
+		if (gameData->gameState == MENU && gameData->game.sim.isStarted)
+		{
+			gameData->gameState = GAME;
+		}
+		mainData->accumulator -= tickTime;
+		tickCount++;
+	}
+
+	// After a long stall drop the backlog: the game slows down instead of draining the life bar at once
+	if (mainData->accumulator >= tickTime)
+	{
+		mainData->accumulator = 0;
+	}
+	_frame->simulateTime = (float)(TimerTicks() - start) / TimerFrequency();
+	PROFILE_END(Simulate);
+}
+
+void ApplyInput(InputSampler* const _input, GameData* const _gameData, int64_t _tickEnd)
+{
+	Game* const game = &_gameData->game;
+	InputEvent event;
+	while (InputPeek(_input, &event) && event.time <= _tickEnd)
+	{
+		InputPop(_input);
+		switch (event.type)
+		{
+		case INPUT_START:
+			if (_gameData->gameState == MENU)
+			{
+				GameStart(game);
+			}
+			break;
+		case INPUT_CHOP_LEFT:
+		case INPUT_CHOP_RIGHT:
+			if (_gameData->gameState == GAME && event.time > game->startTime)
+			{
+				GameChop(game, event.type == INPUT_CHOP_LEFT ? SIM_CHOP_LEFT : SIM_CHOP_RIGHT, event.time);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void PublishRenderState(const Frame* const _frame)
+{
+	PROFILE_BEGIN(Publish);
+	Renderer* const renderer = &_frame->mainData->renderer;
+	RenderState* const state = TripleBufferWriteSlot(&renderer->states);
+	FillRenderState(state, _frame->gameData);
+	state->simulateTime = _frame->simulateTime;
+	TripleBufferPublish(&renderer->states);
+	PROFILE_END(Publish);
+}
+
+void WaitNextTick(MainData* const _mainData)
+{
+	// Drawing and vsync live on the render thread, this loop only sleeps until the next tick is due
+	float tickTime = 1.f / _mainData->tickRate;
+	float elapsed = sfTime_asSeconds(sfClock_getElapsedTime(_mainData->clock));
+	float remaining = tickTime - _mainData->accumulator - elapsed;
+	if (remaining > 0)
+	{
+		sfSleep(sfSeconds(remaining));
+	}
+}
+
+void Draw(RenderTarget* const _target, SpriteBatch* const _batch, StaticLayer* const _background, GameData* const _gameData, const RenderState* const _state)
+{
+	sfBool isCached = DrawBackground(_target, _batch, _background, _gameData, _state);
+
+	// Every sprite goes through the batch, the scores are already one vertex array each
+	SpriteBatchBegin(_batch);
+	if (!isCached)
+	{
+		DrawLevelStatic(_batch, &_gameData->game.level);
+	}
+	DrawLevel(_batch, &_gameData->game.level, _state);
+
+	DrawPlayer(_batch, _state->playerAnimation);
+
+	if (_state->gameState == MENU || _state->gameState == GAME_OVER)
+	{
+		DrawButton(_batch, &_gameData->hud);
+	}
+	if (_state->gameState == MENU)
+	{
+		SpriteBatchAddSprite(_batch, LAYER_HUD, _gameData->hud.title);
+	}
+	else if (_state->gameState == GAME_OVER)
+	{
+		SpriteBatchAddSprite(_batch, LAYER_HUD, _gameData->hud.gameOver);
+	}
+	if (_state->gameState != MENU)
+	{
+		SpriteBatchAddSprite(_batch, LAYER_HUD, _gameData->hud.timeContainer);
+		SpriteBatchAddSprite(_batch, LAYER_HUD_FRONT, _gameData->hud.timeBar);
+	}
+	SpriteBatchEnd(_batch);
+	TargetDrawBatch(_target, _batch);
+
+	if (_state->gameState == GAME_OVER)
+	{
+		TargetDrawVertexArray(_target, _gameData->hud.maxScoreText.vertices, _gameData->hud.digits.texture);
+	}
+	if (_state->gameState != MENU)
+	{
+		TargetDrawVertexArray(_target, _gameData->hud.scoreText.vertices, _gameData->hud.digits.texture);
+	}
+}
+
+sfBool DrawBackground(RenderTarget* const _target, SpriteBatch* const _batch, StaticLayer* const _background, GameData* const _gameData, const RenderState* const _state)
+{
+	if (StaticLayerIsStale(_background, _state->staticVersion)
+		&& StaticLayerBegin(_background, _state->staticVersion, TargetGetSize(_target)))
+	{
+		RenderTarget layerTarget = { NULL, _background->texture, 0, 0, NULL };
+		SpriteBatchBegin(_batch);
+		DrawLevelStatic(_batch, &_gameData->game.level);
+		SpriteBatchEnd(_batch);
+		TargetDrawBatch(&layerTarget, _batch);
+		StaticLayerEnd(_background);
+	}
+
+	// The opaque background covers every pixel the clear would write
+	if (!_background->isValid || !_background->isOpaque)
+	{
+		TargetClear(_target, _gameData->color.blueGrey);
+	}
+	if (_background->isValid)
+	{
+		TargetDrawLayer(_target, _background);
+	}
+	return _background->isValid;
+}
+
+void Cleanup(MainData* const _mainData, GameData* const _gameData)
+{
+	InputStop(&_mainData->input);
+	StopRenderer(_mainData);
+	JobSystemDestroy(&_mainData->jobs);
+	GameEndSession(&_gameData->game);
+	ReplayFree(&_gameData->game.replay);
+
+	ResourceCache* const resources = &_gameData->resources;
+	CleanupPlayer(&_gameData->game.player, resources);
+	CleanupHud(&_gameData->hud, resources);
+	CleanupLevel(&_gameData->game.level, resources);
+	ReleaseAtlasPages(&_gameData->atlas, resources);
+	AtlasDestroy(&_gameData->atlas);
+	// Everything was released by its users, what is left leaks on every run
+	for (int i = 0; i < resources->count; i++)
+	{
+		printf("%s is still referenced %d times at exit\n", resources->resources[i].name, resources->resources[i].refCount);
+	}
+	ResourceCacheDestroy(resources);
+	// Last, the fonts and the music read from the mapping until they are destroyed
+	AssetPackClose(&_gameData->pack);
+
+	sfRenderWindow_close(_mainData->renderWindow);
+	sfRenderWindow_destroy(_mainData->renderWindow);
+	_mainData->renderWindow = NULL;
+
+	TRACK_DESTROY(TRACK_CLOCK, sfClock_destroy, _mainData->clock);
+	_mainData->clock = NULL;
+}
+
+#pragma endregion
+
+#pragma region Profile
+void ToggleProfile(MainData* const _mainData)
+{
+	if (!ProfileIsRunning())
+	{
+		printf("Profiling started\n");
+		ProfileStart();
+		return;
+	}
+
+	ProfileStop();
+	const char* path = _mainData->tracePath ? _mainData->tracePath : DEFAULT_TRACE_PATH;
+	if (ProfileWriteTrace(path))
+	{
+		printf("Profile written to %s\n", path);
+	}
+	else
+	{
+		printf("Could not write %s\n", path);
+	}
+}
+
+void CheckStartup(MainData* const _mainData)
+{
+	// The first frame is the menu, from then on the game answers input
+	int64_t firstFrameTime = AtomicLoad64(&_mainData->renderer.firstFrameTime);
+	if (!firstFrameTime)
+	{
+		return;
+	}
+	StartupMark(STARTUP_INTERACTIVE, firstFrameTime);
+	if (!StartupWriteRun(StartupGetRun(), _mainData->startupPath))
+	{
+		printf("Could not write %s\n", _mainData->startupPath);
+	}
+	_mainData->isRunning = sfFalse;
+}
+#pragma endregion
+
+#pragma region RenderTarget
+void TargetClear(RenderTarget* const _target, sfColor _color)
+{
+	if (_target->texture)
+	{
+		sfRenderTexture_clear(_target->texture, _color);
+	}
+	else
+	{
+		sfRenderWindow_clear(_target->window, _color);
+	}
+}
+
+void TargetDrawBatch(RenderTarget* const _target, const SpriteBatch* const _batch)
+{
+	for (int i = 0; i < _batch->drawCount; i++)
+	{
+		const SpriteDraw* draw = &_batch->draws[i];
+		const sfVertex* vertices = &_batch->vertices[draw->firstVertex];
+		sfRenderStates states = SpriteBatchStates(draw);
+		CountTexture(_target, draw->texture);
+		if (_target->texture)
+		{
+			sfRenderTexture_drawPrimitives(_target->texture, vertices, draw->vertexCount, sfQuads, &states);
+		}
+		else
+		{
+			sfRenderWindow_drawPrimitives(_target->window, vertices, draw->vertexCount, sfQuads, &states);
+		}
+	}
+}
+
+void TargetDrawText(RenderTarget* const _target, const sfText* const _text)
+{
+	// Glyphs come from the font page of the character size
+	CountTexture(_target, sfFont_getTexture((sfFont*)sfText_getFont(_text), sfText_getCharacterSize(_text)));
+	if (_target->texture)
+	{
+		sfRenderTexture_drawText(_target->texture, _text, NULL);
+	}
+	else
+	{
+		sfRenderWindow_drawText(_target->window, _text, NULL);
+	}
+}
+
+void TargetDrawRectangle(RenderTarget* const _target, const sfRectangleShape* const _rectangle)
+{
+	CountTexture(_target, sfRectangleShape_getTexture(_rectangle));
+	if (_target->texture)
+	{
+		sfRenderTexture_drawRectangleShape(_target->texture, _rectangle, NULL);
+	}
+	else
+	{
+		sfRenderWindow_drawRectangleShape(_target->window, _rectangle, NULL);
+	}
+}
+
+void TargetDrawVertexArray(RenderTarget* const _target, const sfVertexArray* const _vertices, const sfTexture* const _texture)
+{
+	sfRenderStates states = { sfBlendAlpha, sfTransform_Identity, _texture, NULL };
+	CountTexture(_target, _texture);
+	if (_target->texture)
+	{
+		sfRenderTexture_drawVertexArray(_target->texture, _vertices, &states);
+	}
+	else
+	{
+		sfRenderWindow_drawVertexArray(_target->window, _vertices, &states);
+	}
+}
+
+void TargetDrawLayer(RenderTarget* const _target, const StaticLayer* const _layer)
+{
+	sfRenderStates states = StaticLayerStates(_layer);
+	CountTexture(_target, sfSprite_getTexture(_layer->sprite));
+	if (_target->texture)
+	{
+		sfRenderTexture_drawSprite(_target->texture, _layer->sprite, &states);
+	}
+	else
+	{
+		sfRenderWindow_drawSprite(_target->window, _layer->sprite, &states);
+	}
+}
+
+sfVector2u TargetGetSize(const RenderTarget* const _target)
+{
+	if (_target->texture)
+	{
+		return sfRenderTexture_getSize(_target->texture);
+	}
+	return sfRenderWindow_getSize(_target->window);
+}
+
+void CountTexture(RenderTarget* const _target, const sfTexture* const _texture)
+{
+	// Every draw is one draw call in SFML, the texture binding only changes when the texture does
+	_target->drawCount++;
+	if (_texture != _target->lastTexture)
+	{
+		_target->textureSwitchCount++;
+		_target->lastTexture = _texture;
+	}
+}
+
+void ResetTargetStats(RenderTarget* const _target)
+{
+	_target->drawCount = 0;
+	_target->textureSwitchCount = 0;
+	_target->lastTexture = NULL;
+}
+
+void TargetDisplay(RenderTarget* const _target)
+{
+	if (_target->texture)
+	{
+		sfRenderTexture_display(_target->texture);
+	}
+	else
+	{
+		sfRenderWindow_display(_target->window);
+	}
+}
+#pragma endregion
+
+#pragma region Latency
+void StartLatencyTest(MainData* const _mainData, int _chopCount)
+{
+	LatencyTest* const test = &_mainData->latencyTest;
+	test->isActive = _chopCount > 0;
+	test->remaining = _chopCount;
+	test->nextTime = 0;
+	test->endTime = 0;
+	RandomSeed(&test->random, 1);
+	_mainData->renderer.isOffscreen = test->isActive;
+}
+
+void InjectInput(MainData* const _mainData, GameData* const _gameData)
+{
+	LatencyTest* const test = &_mainData->latencyTest;
+	int64_t now = TimerTicks();
+	int64_t frequency = TimerFrequency();
+
+	if (test->remaining == 0)
+	{
+		if (now >= test->endTime)
+		{
+			_mainData->isRunning = sfFalse;
+		}
+		return;
+	}
+	if (now < test->nextTime)
+	{
+		return;
+	}
+
+	// Jittered so the presses do not lock onto the frame or tick phase
+	float interval = LATENCY_TEST_INTERVAL * (0.5f + RandomFloat(&test->random));
+	test->nextTime = now + (int64_t)(interval * frequency);
+	switch (_gameData->gameState)
+	{
+	case MENU:
+		InputPush(&_mainData->input, INPUT_START, now);
+		break;
+	case GAME:
+		// The bot side keeps the run going, a death would only measure the menu
+		InputPush(&_mainData->input, SolverChoose(&_gameData->game.sim) == SIM_CHOP_LEFT ? INPUT_CHOP_LEFT : INPUT_CHOP_RIGHT, now);
+		test->remaining--;
+		test->endTime = now + (int64_t)(LATENCY_TEST_SETTLE * frequency);
+		break;
+	case GAME_OVER:
+		Reset(_gameData);
+		break;
+	default:
+		break;
+	}
+}
+
+sfBool ReportLatency(MainData* const _mainData)
+{
+	if (LatencyCount(&_mainData->latency, LATENCY_INPUT_TO_TICK) == 0 && !_mainData->latencyTest.isActive)
+	{
+		return sfTrue;
+	}
+
+	LatencyWriteSummary(stdout, &_mainData->latency);
+	if (_mainData->latencyPath)
+	{
+		FILE* file = FileOpen(_mainData->latencyPath, "w");
+		if (file)
+		{
+			LatencyWriteJson(file, &_mainData->latency);
+			fclose(file);
+		}
+		else
+		{
+			printf("Could not write %s\n", _mainData->latencyPath);
+		}
+	}
+
+	if (!_mainData->latencyTest.isActive)
+	{
+		return sfTrue;
+	}
+	// A wrong marker means the frame read back was not the one the state described
+	int mismatchCount = _mainData->renderer.markerMismatchCount;
+	if (mismatchCount)
+	{
+		printf("%d frames read back with a stale marker\n", mismatchCount);
+	}
+	return mismatchCount == 0 && LatencyCount(&_mainData->latency, LATENCY_INPUT_TO_DISPLAY) > 0;
+}
+#pragma endregion
+
+#pragma region Renderer
+void StartRenderer(MainData* const _mainData, GameData* const _gameData)
+{
+	Renderer* const renderer = &_mainData->renderer;
+	renderer->renderWindow = _mainData->renderWindow;
+	renderer->gameData = _gameData;
+	renderer->latency = &_mainData->latency;
+	renderer->target = (RenderTarget){ _mainData->renderWindow, NULL, 0, 0, NULL };
+	renderer->clock = TRACK_CREATE(TRACK_CLOCK, sfClock_create());
+	if (!SpriteBatchCreate(&renderer->batch))
+	{
+		printf("Could not create the sprite batch\n");
+	}
+	// Its render texture is only created on the render thread, at the first frame
+	if (!StaticLayerCreate(&renderer->background, (sfVector2f) { SCREEN_WIDTH, SCREEN_HEIGHT }, sfTrue))
+	{
+		printf("Could not create the background layer\n");
+	}
+	if (!OverlayCreate(&renderer->overlay, _gameData->hud.font, (sfVector2f) { 10, 10 }, 1.f / MAX_FPS))
+	{
+		printf("Could not create the performance overlay\n");
+	}
+	renderer->overlay.textureBytes = ResourceCacheTextureBytes(&_gameData->resources);
+	for (int i = 0; i < 3; i++)
+	{
+		FillRenderState(&renderer->slots[i], _gameData);
+	}
+	TripleBufferInit(&renderer->states, &renderer->slots[0], &renderer->slots[1], &renderer->slots[2]);
+	_mainData->isRunning = sfTrue;
+
+	// The OpenGL context can only be active on one thread at a time
+	sfRenderWindow_setActive(_mainData->renderWindow, sfFalse);
+	renderer->isRunning = 1;
+	if (!ThreadStart(&renderer->thread, RenderThread, renderer))
+	{
+		printf("Could not start the render thread\n");
+		renderer->isRunning = 0;
+		_mainData->isRunning = sfFalse;
+	}
+}
+
+void StopRenderer(MainData* const _mainData)
+{
+	Renderer* const renderer = &_mainData->renderer;
+	if (AtomicExchange32(&renderer->isRunning, 0))
+	{
+		ThreadWait(&renderer->thread);
+	}
+	sfRenderWindow_setActive(_mainData->renderWindow, sfTrue);
+
+	OverlayDestroy(&renderer->overlay);
+	SpriteBatchDestroy(&renderer->batch);
+	StaticLayerDestroy(&renderer->background);
+	TRACK_DESTROY(TRACK_CLOCK, sfClock_destroy, renderer->clock);
+	renderer->clock = NULL;
+}
+
+void RenderThread(void* _renderer)
+{
+	Renderer* const renderer = _renderer;
+	ProfileSetThreadName("render");
+	sfRenderWindow_setActive(renderer->renderWindow, sfTrue);
+	if (renderer->isOffscreen)
 	{
-		UpdateButton(dt, _mainData->renderWindow, _gameData);
+		CreateOffscreen(renderer);
 	}
-	if (_gameData->game.player.dead)
+
+	while (AtomicLoad32(&renderer->isRunning))
 	{
-		_gameData->gameState = GAME_OVER;
+		// Never waits on the simulation: an old state is drawn again if no new one was published
+		RenderFrame frame = { renderer->gameData, TripleBufferRead(&renderer->states, NULL),
+			sfTime_asSeconds(sfClock_restart(renderer->clock)) };
+		int64_t start = TimerTicks();
+
+		// Inline: the job system belongs to the main thread, and the simulation must never wait on render work
+		RenderHudPhase(&frame);
+		RenderLevelPhase(&frame);
+		RenderPlayerPhase(&frame);
+		int64_t prepared = TimerTicks();
+
+		PROFILE_BEGIN(Draw);
+		Draw(&renderer->target, &renderer->batch, &renderer->background, renderer->gameData, frame.state);
+		if (frame.state->isDebug)
+		{
+			DrawOverlay(renderer, frame.dt);
+		}
+		PROFILE_END(Draw);
+		int64_t drawn = TimerTicks();
+
+		PresentFrame(renderer, frame.state);
+		if (!renderer->firstFrameTime)
+		{
+			AtomicStore64(&renderer->firstFrameTime, TimerTicks());
+		}
+
+		float frequency = (float)TimerFrequency();
+		float phaseTimes[OVERLAY_PHASE_COUNT] =
+		{
+			frame.state->simulateTime,
+			(prepared - start) / frequency,
+			(drawn - prepared) / frequency,
+			(TimerTicks() - drawn) / frequency,
+		};
+		OverlayAddFrame(&renderer->overlay, frame.dt, phaseTimes, renderer->target.drawCount, renderer->target.textureSwitchCount);
+		ResetTargetStats(&renderer->target);
 	}
-	UpdateGame(dt, &_gameData->game, &_gameData->hud, _gameData->gameState);
+
+	DestroyOffscreen(renderer);
+	sfRenderWindow_setActive(renderer->renderWindow, sfFalse);
 }
 
-void Draw(sfRenderWindow* const _renderWindow, GameData* const _gameData)
+void CreateOffscreen(Renderer* const _renderer)
 {
-	sfRenderWindow_clear(_renderWindow, _gameData->color.blueGrey);
+	sfVector2u size = sfRenderWindow_getSize(_renderer->renderWindow);
+	_renderer->target.texture = sfRenderTexture_create(size.x, size.y, sfFalse);
+	if (!_renderer->target.texture)
+	{
+		printf("Could not create the offscreen target, latency is measured on the window\n");
+		return;
+	}
+	_renderer->offscreenSprite = TRACK_CREATE(TRACK_SPRITE, sfSprite_create());
+	sfSprite_setTexture(_renderer->offscreenSprite, sfRenderTexture_getTexture(_renderer->target.texture), sfTrue);
+	_renderer->marker = sfRectangleShape_create();
+	sfRectangleShape_setSize(_renderer->marker, (sfVector2f) { 2, 2 });
+}
 
-	DrawLevel(_renderWindow, &_gameData->game.level);
+void DestroyOffscreen(Renderer* const _renderer)
+{
+	if (_renderer->marker)
+	{
+		sfRectangleShape_destroy(_renderer->marker);
+		_renderer->marker = NULL;
+	}
+	if (_renderer->offscreenSprite)
+	{
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _renderer->offscreenSprite);
+		_renderer->offscreenSprite = NULL;
+	}
+	if (_renderer->target.texture)
+	{
+		sfRenderTexture_destroy(_renderer->target.texture);
+		_renderer->target.texture = NULL;
+	}
+}
 
-	DrawPlayer(_renderWindow, &_gameData->game.player);
+void PresentFrame(Renderer* const _renderer, const RenderState* const _state)
+{
+	RenderTarget* const target = &_renderer->target;
+	if (target->texture)
+	{
+		sfRectangleShape_setFillColor(_renderer->marker, MarkerColor(_state->chopSequence));
+		TargetDrawRectangle(target, _renderer->marker);
+	}
+	PROFILE_BEGIN(Display);
+	TargetDisplay(target);
+	PROFILE_END(Display);
 
-	if (_gameData->gameState == MENU || _gameData->gameState == GAME_OVER)
+	sfBool isNewChop = _state->chopSequence != _renderer->shownChopSequence;
+	if (isNewChop && target->texture)
 	{
-		DrawButton(_renderWindow, &_gameData->hud);
+		// Reading the pixels back only returns once the GPU has finished the frame
+		sfImage* image = sfTexture_copyToImage(sfRenderTexture_getTexture(target->texture));
+		sfColor pixel = sfImage_getPixel(image, 0, 0);
+		sfColor expected = MarkerColor(_state->chopSequence);
+		sfImage_destroy(image);
+		if (pixel.r != expected.r || pixel.g != expected.g || pixel.b != expected.b)
+		{
+			_renderer->markerMismatchCount++;
+		}
 	}
-	if (_gameData->gameState == MENU)
+	if (isNewChop)
 	{
-		sfRenderWindow_drawSprite(_renderWindow, _gameData->hud.title, NULL);
+		int64_t now = TimerTicks();
+		_renderer->shownChopSequence = _state->chopSequence;
+		if (_state->chopInputTime)
+		{
+			LatencyRecord(_renderer->latency, LATENCY_TICK_TO_DISPLAY, now - _state->chopApplyTime);
+			LatencyRecord(_renderer->latency, LATENCY_INPUT_TO_DISPLAY, now - _state->chopInputTime);
+		}
 	}
-	else if (_gameData->gameState == GAME_OVER)
+
+	// The window still shows the offscreen frame, after the measurement
+	if (target->texture)
 	{
-		sfRenderWindow_drawSprite(_renderWindow, _gameData->hud.gameOver, NULL);
-		sfRenderWindow_drawText(_renderWindow, _gameData->hud.maxScoreText, NULL);
+		sfRenderWindow_clear(_renderer->renderWindow, sfBlack);
+		sfRenderWindow_drawSprite(_renderer->renderWindow, _renderer->offscreenSprite, NULL);
+		sfRenderWindow_display(_renderer->renderWindow);
 	}
-	if (_gameData->gameState != MENU)
+}
+
+void DrawOverlay(Renderer* const _renderer, float _dt)
+{
+	Overlay* const overlay = &_renderer->overlay;
+	if (overlay->vertices)
 	{
-		sfRenderWindow_drawSprite(_renderWindow, _gameData->hud.timeContainer, NULL);
-		sfRenderWindow_drawSprite(_renderWindow, _gameData->hud.timeBar, NULL);
-		sfRenderWindow_drawText(_renderWindow, _gameData->hud.scoreText, NULL);
+		OverlayUpdate(overlay, _dt);
+		TargetDrawVertexArray(&_renderer->target, overlay->vertices, NULL);
+		TargetDrawText(&_renderer->target, overlay->text);
 	}
-	if (_gameData->isDebug)
+}
+
+sfColor MarkerColor(uint32_t _chopSequence)
+{
+	return sfColor_fromRGB((_chopSequence >> 16) & 0xFF, (_chopSequence >> 8) & 0xFF, _chopSequence & 0xFF);
+}
+
+void FillRenderState(RenderState* const _state, const GameData* const _gameData)
+{
+	const Game* const game = &_gameData->game;
+	const Simulation* const sim = &game->sim;
+
+	_state->gameState = _gameData->gameState;
+	_state->truncCount = sim->height;
+	for (int i = 0; i < sim->height; i++)
 	{
-		sfRenderWindow_drawText(_renderWindow, _gameData->hud.fpsText, NULL);
+		_state->trunc[i] = SimGetTrunc(sim, i);
 	}
-	sfRenderWindow_display(_renderWindow);
+	_state->session = game->session;
+	_state->score = sim->score;
+	_state->maxScore = game->maxScore;
+	_state->playerAnimation = game->player.animation.currentAnim;
+	_state->playerFrame = game->player.animation.currentAnim->currentFrame;
+	_state->dir = sim->dir;
+	_state->isDead = sim->dead;
+	_state->lifeFraction = sim->lifeTime / sim->config.maxLifeTime;
+	_state->isButtonHovered = _gameData->hud.isColiding;
+	_state->isDebug = _gameData->isDebug;
+	_state->staticVersion = _gameData->staticVersion;
+	_state->chopSequence = game->chopSequence;
+	_state->chopInputTime = game->chopInputTime;
+	_state->chopApplyTime = game->chopApplyTime;
 }
 
-void Cleanup(MainData* const _mainData, GameData* const _gameData)
+void RenderHudPhase(const RenderFrame* const _frame)
 {
-	CleanupPlayer(&_gameData->game.player);
-	CleanupHud(&_gameData->hud);
-	CleanupLevel(&_gameData->game.level);
-
-	sfRenderWindow_destroy(_mainData->renderWindow);
-	_mainData->renderWindow = NULL;
+	PROFILE_BEGIN(UpdateHud);
+	UpdateHud(_frame->dt, &_frame->gameData->hud, _frame->state);
+	PROFILE_END(UpdateHud);
+}
 
-	sfClock_destroy(_mainData->clock);
-	_mainData->clock = NULL;
+void RenderLevelPhase(const RenderFrame* const _frame)
+{
+	PROFILE_BEGIN(UpdateTrunc);
+	UpdateTrunc(&_frame->gameData->game.level, _frame->state);
+	PROFILE_END(UpdateTrunc);
 }
 
+void RenderPlayerPhase(const RenderFrame* const _frame)
+{
+	PROFILE_BEGIN(UpdatePlayer);
+	SetAnimationFrame(_frame->state->playerAnimation, _frame->state->playerFrame);
+	PlayerUpdateMovement(&_frame->gameData->game.player, _frame->state);
+	PROFILE_END(UpdatePlayer);
+}
 #pragma endregion
 
 void Reset(GameData* const _gameData)
 {
-	_gameData->game.isGameStarted = sfFalse;
-	_gameData->game.lifeTime = 5;
-	_gameData->game.score = 0;
 	_gameData->gameState = MENU;
-	Level* level = &_gameData->game.level;
-	AsigneTruncTexture(&level->trunc1, rand() % 2, &level->texture);
-	AsigneTruncTexture(&level->trunc2, rand() % 2, &level->texture);
-	AsigneTruncTexture(&level->trunc3, rand() % 2, &level->texture);
-	AsigneTruncTexture(&level->trunc4, rand() % 2, &level->texture);
-	AsigneTruncTexture(&level->trunc5, rand() % 2, &level->texture);
-	AsigneTruncTexture(&level->trunc6, rand() % 2, &level->texture);
-	_gameData->game.player.dir = BASE_POSITION;
-	_gameData->game.player.dead = sfFalse;
+	GameEndSession(&_gameData->game);
+
+	// Every session gets its own seed so it can be replayed on its own
+	if (!_gameData->game.isReplaying)
+	{
+		_gameData->game.seed++;
+	}
+	GameBeginSession(&_gameData->game);
 }
 
-void CreateSprite(sfSprite** const _sprite, sfVector2f position, const char* _filepath)
+sfVector2i CreateSprite(sfSprite** const _sprite, sfVector2f position, const Atlas* const _atlas, const char* _name)
 {
-	*_sprite = sfSprite_create();
+	*_sprite = TRACK_CREATE(TRACK_SPRITE, sfSprite_create());
 	sfSprite_setPosition(*_sprite, position);
 
-	sfTexture* texture = sfTexture_createFromFile(_filepath, NULL);
-	sfSprite_setTexture(*_sprite, texture, sfTrue);
+	// The origin is the pivot of the atlas, the size is the one of the untrimmed image
+	const AtlasSprite* sheet = AtlasFind(_atlas, _name);
+	AtlasSetSprite(*_sprite, _atlas, sheet, 0);
+	return sheet->size;
 }
 
-void UpdateText(sfText* const _text, int _value)
-{
-	// Copy the value into the text
-	char string[5];
-	sprintf_s(string, sizeof(string), "%d", _value);
-	sfText_setString(_text, string);
-}
 #pragma region Animation
-void SetupAnimation(Animation* _anim, sfTexture** const _texture, int _frameCount, float _frameRate, sfBool _isLooping)
+void SetupAnimation(Animation* _anim, const Atlas* const _atlas, const char* _name, float _frameRate, sfBool _isLooping)
 {
-	// Charger la texture
-	//printf("%c\n", _filepath);
-	_anim->sprite = sfSprite_create();
-	sfSprite_setTexture(_anim->sprite, *_texture, sfTrue);
+	_anim->sprite = TRACK_CREATE(TRACK_SPRITE, sfSprite_create());
+	_anim->atlas = _atlas;
+	_anim->sheet = AtlasFind(_atlas, _name);
 
 	// D�finir les attributs de l'animation
-	_anim->frameCount = _frameCount;
+	_anim->frameCount = _anim->sheet->frameCount;
 	_anim->frameRate = 1 / _frameRate;
 	_anim->currentFrame = 0;
 	_anim->isLooping = _isLooping;
 	_anim->isFinished = sfFalse;
 
-	// Calculer la taille de la texture pour d�couper les frames
-	sfIntRect rect = { 0 };
-	sfVector2u textureSize = sfTexture_getSize(*_texture);
-
-	int frameWidth = textureSize.x / _frameCount;
-	int frameHeight = textureSize.y;
-
-	// Initialiser le rectangle de la texture pour le sprite
-	rect.top = 0;
-	rect.left = 0;
-	rect.width = frameWidth;
-	rect.height = frameHeight;
-
-	sfSprite_setTextureRect(_anim->sprite, rect);
-
-	sfVector2f origin = { frameWidth / 2.0f, (float)frameHeight };
-	sfSprite_setOrigin(_anim->sprite, origin);
+	// Frames are cut and trimmed by AssetTool, the pivot is the feet of the character
+	AtlasSetSprite(_anim->sprite, _atlas, _anim->sheet, 0);
+	_anim->shownFrame = 0;
 }
 
 void AnimateSprite(Animation* _anim, float const _dt)
 {
+	// Only advances the frame, the render thread moves the texture rect
 	if (_anim != NULL)
 	{
-		sfIntRect area = sfSprite_getTextureRect(_anim->sprite);
-		sfVector2u textureSize = sfTexture_getSize(sfSprite_getTexture(_anim->sprite));
-		int frameWidth = textureSize.x / _anim->frameCount;
-
 		if (!_anim->isFinished) {
-			area.left += frameWidth;
+			_anim->currentFrame++;
 
-			if (area.left >= _anim->frameCount * frameWidth) {
-				if (_anim->isLooping) {
-					area.left = 0;
-				}
-				else {
-					area.left = 0;
+			if (_anim->currentFrame >= _anim->frameCount) {
+				_anim->currentFrame = 0;
+				if (!_anim->isLooping) {
 					_anim->isFinished = sfTrue;
 				}
 			}
-
-			sfSprite_setTextureRect(_anim->sprite, area);
 		}
 	}
 }
 
+void SetAnimationFrame(Animation* const _anim, int _frame)
+{
+	// Trimmed frames differ in size, the origin moves with the texture rect
+	if (_anim->shownFrame != _frame)
+	{
+		AtlasSetSprite(_anim->sprite, _anim->atlas, _anim->sheet, _frame);
+		_anim->shownFrame = _frame;
+	}
+}
+
 sfBool AnimIsFinished(Animation* const _anim)
 {
 	return _anim->isFinished;
@@ -453,12 +1552,9 @@ sfBool AnimIsFinished(Animation* const _anim)
 
 void cleanupAnimation(Animation* animation)
 {
-	if (animation->texture) {
-		sfTexture_destroy(animation->texture);
-		animation->texture = NULL;
-	}
+	// The frames belong to the atlas
 	if (animation->sprite) {
-		sfSprite_destroy(animation->sprite);
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, animation->sprite);
 		animation->sprite = NULL;
 	}
 }
@@ -469,558 +1565,538 @@ void LoadScreen(MainData* const _mainData)
 {
 	sfVideoMode videoMode = { SCREEN_WIDTH, SCREEN_HEIGHT, BPP };
 	_mainData->renderWindow = sfRenderWindow_create(videoMode, SCREEN_NAME, sfDefaultStyle, NULL);
+	StartupMark(STARTUP_WINDOW, TimerTicks());
 	sfRenderWindow_setVerticalSyncEnabled(_mainData->renderWindow, sfFalse);
 	sfRenderWindow_setFramerateLimit(_mainData->renderWindow, MAX_FPS);
+	DrawLoadScreen(_mainData->renderWindow, 0.f);
+	StartupMark(STARTUP_FIRST_DISPLAY, TimerTicks());
+}
+
+void DrawLoadScreen(sfRenderWindow* const _renderWindow, float _progress)
+{
+	// Plain shapes: no asset is needed before the first frame
+	sfVector2f size = { SCREEN_WIDTH * 0.6f, 12 };
+	sfVector2f position = { (SCREEN_WIDTH - size.x) / 2, SCREEN_HEIGHT * 0.5f };
+	sfRectangleShape* frame = sfRectangleShape_create();
+	sfRectangleShape* bar = sfRectangleShape_create();
+	sfRectangleShape_setSize(frame, size);
+	sfRectangleShape_setPosition(frame, position);
+	sfRectangleShape_setFillColor(frame, sfColor_fromRGB(70, 80, 90));
+	sfRectangleShape_setSize(bar, (sfVector2f) { size.x * _progress, size.y });
+	sfRectangleShape_setPosition(bar, position);
+	sfRectangleShape_setFillColor(bar, sfWhite);
+
+	sfRenderWindow_clear(_renderWindow, sfColor_fromRGB(119, 136, 153));
+	sfRenderWindow_drawRectangleShape(_renderWindow, frame, NULL);
+	sfRenderWindow_drawRectangleShape(_renderWindow, bar, NULL);
+	sfRenderWindow_display(_renderWindow);
+	sfRectangleShape_destroy(bar);
+	sfRectangleShape_destroy(frame);
 }
 
-void LoadHud(HUD* const _hud)
+sfBool WaitLoader(MainData* const _mainData, const Loader* const _loader)
 {
-	_hud->font = sfFont_createFromFile("Assets/Fonts/arial.ttf");
-	_hud->fpsText = sfText_create();
-	sfText_setCharacterSize(_hud->fpsText, 25);
-	sfText_setFont(_hud->fpsText, _hud->font);
-	sfVector2f textPosition = { 20, 20 };
-	sfText_setPosition(_hud->fpsText, textPosition);
+	// The window keeps answering while the workers decode, a close is only remembered
+	sfBool isClosed = sfFalse;
+	do
+	{
+		sfEvent event;
+		while (sfRenderWindow_pollEvent(_mainData->renderWindow, &event))
+		{
+			isClosed = isClosed || event.type == sfEvtClosed;
+		}
+		DrawLoadScreen(_mainData->renderWindow, LoaderProgress(_loader));
+	} while (!LoaderIsDone(_loader));
+	return isClosed;
+}
 
-	sfVector2f nill = { 0, 0 };
-	CreateSprite(&_hud->title, nill, "Assets/Sprites/Title.png");
+sfBool LoadAtlas(Atlas* const _atlas, const AssetPack* const _pack)
+{
+	// Everything the game looks up, a stale atlas is rejected here rather than drawn wrong
+	static const char* names[] = { "Background", "Stump", "Trunk1", "Trunk2", "BranchLeft", "BranchRight",
+		"ManIdle", "ManWoodcutting", "RIP", "Title", "PlayButton", "GameOver", "TimeContainer", "TimeBar" };
+	size_t size = 0;
+	const void* data = AssetPackGet(_pack, ATLAS_ENTRY, &size);
+	if (!data || !AtlasRead(_atlas, data, size))
+	{
+		return sfFalse;
+	}
+	for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+	{
+		if (!AtlasFind(_atlas, names[i]))
+		{
+			printf("The atlas has no sprite %s\n", names[i]);
+			AtlasDestroy(_atlas);
+			return sfFalse;
+		}
+	}
+	return sfTrue;
+}
+
+sfBool LoadAtlasPages(Atlas* const _atlas, ResourceCache* const _resources)
+{
+	// Decoded by the workers, only the upload needs the context of this thread
+	for (int i = 0; i < _atlas->pageCount; i++)
+	{
+		char page[ATLAS_PATH_LENGTH];
+		AtlasPagePath(_atlas, ATLAS_ENTRY, i, page, sizeof(page));
+		int64_t start = TimerTicks();
+		_atlas->textures[i] = ResourceGetTexture(_resources, page);
+		StartupAddAsset(page, 0, 0, TimerTicks() - start);
+		if (!CheckResource(_resources, page, _atlas->textures[i]))
+		{
+			ReleaseAtlasPages(_atlas, _resources);
+			AtlasDestroy(_atlas);
+			return sfFalse;
+		}
+	}
+	return sfTrue;
+}
+
+void ReleaseAtlasPages(Atlas* const _atlas, ResourceCache* const _resources)
+{
+	for (int i = 0; i < ATLAS_MAX_PAGES; i++)
+	{
+		ResourceRelease(_resources, _atlas->textures[i]);
+		_atlas->textures[i] = NULL;
+	}
+}
+
+sfBool CheckResource(const ResourceCache* const _resources, const char* _name, const void* _resource)
+{
+	if (!_resource)
+	{
+		printf(AssetPackFind(_resources->pack, _name) ? "%s is corrupt or could not be decoded\n" : "%s is not in the asset pack\n", _name);
+	}
+	return _resource != NULL;
+}
 
-	sfVector2u titleSize = sfTexture_getSize(sfSprite_getTexture(_hud->title));
-	sfSprite_setOrigin(_hud->title, (sfVector2f) { (float)titleSize.x / 2, 0 });
+void LoadHud(HUD* const _hud, const Atlas* const _atlas, ResourceCache* const _resources)
+{
+	// Fonts read their glyphs from the memory they were created from, the pack stays mapped until Cleanup
+	_hud->font = ResourceGetFont(_resources, "Fonts/arial.ttf");
+	CheckResource(_resources, "Fonts/arial.ttf", _hud->font);
+
+	sfVector2f nill = { 0, 0 };
+	sfVector2i titleSize = CreateSprite(&_hud->title, nill, _atlas, "Title");
 	sfVector2f titlePosition = { SCREEN_WIDTH / 2,  (SCREEN_HEIGHT / 2) - (float) (titleSize.y / 2) };
 	sfSprite_setPosition(_hud->title, titlePosition);
 
-	CreateSprite(&_hud->button, nill, "Assets/Sprites/PlayButton.png");
-
-	sfVector2u buttonSize = sfTexture_getSize(sfSprite_getTexture(_hud->button));
-	sfSprite_setOrigin(_hud->button, (sfVector2f) { (float)buttonSize.x / 2, 0 });
+	sfVector2i buttonSize = CreateSprite(&_hud->button, nill, _atlas, "PlayButton");
 	sfVector2f buttonPosition = { SCREEN_WIDTH / 2,  titlePosition.y + (titleSize.y) + buttonSize.y / 2 };
 	sfSprite_setPosition(_hud->button, buttonPosition);
+	_hud->buttonRect = sfSprite_getGlobalBounds(_hud->button);
 
-	CreateSprite(&_hud->gameOver, nill, "Assets/Sprites/GameOver.png");
-
-	sfVector2u gameOverSize = sfTexture_getSize(sfSprite_getTexture(_hud->gameOver));
-	sfSprite_setOrigin(_hud->gameOver, (sfVector2f) { (float)gameOverSize.x / 2, 0 });
+	sfVector2i gameOverSize = CreateSprite(&_hud->gameOver, nill, _atlas, "GameOver");
 	sfVector2f gameOverPosition = { SCREEN_WIDTH / 2,  0 };
 	sfSprite_setPosition(_hud->gameOver, gameOverPosition);
 
 	_hud->isColiding = sfFalse;
+	_hud->isLaidOut = sfFalse;
 
-	CreateSprite(&_hud->timeContainer, nill, "Assets/Sprites/TimeContainer.png");
-
-	sfVector2u timeContainerSize = sfTexture_getSize(sfSprite_getTexture(_hud->timeContainer));
-	sfSprite_setOrigin(_hud->timeContainer, (sfVector2f) { (float)timeContainerSize.x / 2, 0 });
+	CreateSprite(&_hud->timeContainer, nill, _atlas, "TimeContainer");
 	sfVector2f timeContainerPosition = { SCREEN_WIDTH / 2,  SCREEN_HEIGHT * 0.05f };
 	sfSprite_setPosition(_hud->timeContainer, timeContainerPosition);
 
 
-	CreateSprite(&_hud->timeBar, nill, "Assets/Sprites/TimeBar.png");
-
-	sfVector2u timeBarSize = sfTexture_getSize(sfSprite_getTexture(_hud->timeBar));
-	sfSprite_setOrigin(_hud->timeBar, (sfVector2f) { (float)timeBarSize.x / 2, 0 });
+	sfVector2i timeBarSize = CreateSprite(&_hud->timeBar, nill, _atlas, "TimeBar");
+	// The life bar shrinks the trimmed rect, whatever the border that was cut off
+	_hud->timeBarWidth = sfSprite_getTextureRect(_hud->timeBar).width;
 	sfVector2f timeBarPosition = { SCREEN_WIDTH / 2, SCREEN_HEIGHT * 0.04f + timeBarSize.y / 2 };
 	sfSprite_setPosition(_hud->timeBar, timeBarPosition);
 
-	_hud->fontScore = sfFont_createFromFile("Assets/Fonts/KomikaParch.ttf");
-	_hud->scoreText = sfText_create();
-	sfText_setCharacterSize(_hud->scoreText, 35);
-	sfText_setFont(_hud->scoreText, _hud->fontScore);
-	sfFloatRect scoreSize = sfText_getLocalBounds(_hud->scoreText);
-	sfText_setOrigin(_hud->scoreText, (sfVector2f) { (float)scoreSize.width / 2, scoreSize.height / 2 });
-
-	sfVector2f textScorePosition = { SCREEN_WIDTH / 2 , SCREEN_HEIGHT * 0.13f };
-	sfText_setPosition(_hud->scoreText, textScorePosition);
-
-	_hud->maxScoreText = sfText_create();
-	sfText_setCharacterSize(_hud->maxScoreText, 35);
-	sfText_setFont(_hud->maxScoreText, _hud->fontScore);
-
-	sfFloatRect gameOverBounds = sfSprite_getGlobalBounds(_hud->gameOver);
-	sfFloatRect maxScoreBounds = sfText_getLocalBounds(_hud->maxScoreText);
-
-
-	sfVector2f maxScorePosition = { SCREEN_WIDTH / 2, gameOverBounds.top + gameOverBounds.height / 1.5f };
-
-	sfText_setOrigin(_hud->maxScoreText, (sfVector2f) { maxScoreBounds.width / 2, maxScoreBounds.height / 2 });
-	sfText_setPosition(_hud->maxScoreText, maxScorePosition);
+	// Scores only ever show digits: they are baked once and the font is not kept
+	sfFont* fontScore = ResourceGetFont(_resources, "Fonts/KomikaParch.ttf");
+	CheckResource(_resources, "Fonts/KomikaParch.ttf", fontScore);
+	int64_t start = TimerTicks();
+	if (!DigitFontCreate(&_hud->digits, fontScore, SCORE_CHARACTER_SIZE))
+	{
+		printf("Could not bake the score digits\n");
+	}
+	// The baked glyphs are the upload of this font
+	StartupAddAsset("Fonts/KomikaParch.ttf", 0, 0, TimerTicks() - start);
+	ResourceRelease(_resources, fontScore);
+	DigitTextCreate(&_hud->scoreText);
+	DigitTextCreate(&_hud->maxScoreText);
 
+	_hud->maxScorePosition = (sfVector2f){ SCREEN_WIDTH / 2, gameOverPosition.y + gameOverSize.y / 1.5f };
 }
-void UpdateHud(float const _dt, GameData* const _gameData)
+void UpdateHud(float const _dt, HUD* const _hud, const RenderState* const _state)
 {
-	HUD* const hud = &_gameData->hud;
-	Game* const game = &_gameData->game;
-	GameState const gameState = _gameData->gameState;
-	if (_gameData->isDebug)
+	HUD* const hud = _hud;
+	GameState const gameState = _state->gameState;
+	int lifeWidth = (int)(hud->timeBarWidth * _state->lifeFraction);
+
+	// Retained: texts are only formatted and laid out again when what they show changed
+	unsigned int dirty = hud->isLaidOut ? 0 : HUD_DIRTY_ALL;
+	if (_state->score != hud->shownScore || gameState != hud->shownState)
 	{
-		char buffer[11];
-		snprintf(buffer, sizeof(buffer), "Fps: %.2f", 1 / _dt);
-		sfText_setString(hud->fpsText, buffer);
+		dirty |= HUD_DIRTY_SCORE;
 	}
-
-	UpdateText(hud->scoreText, game->score);
-	UpdateText(hud->maxScoreText, game->maxScore);
-
-	if (gameState == GAME_OVER)
+	if (_state->maxScore != hud->shownMaxScore)
 	{
-		sfFloatRect scoreSize = sfText_getLocalBounds(hud->scoreText);
-		sfText_setOrigin(hud->scoreText, (sfVector2f) { (float)scoreSize.width / 2, scoreSize.height / 2 });
-		sfVector2f scorePosition = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2.1f };
-		sfText_setPosition(hud->scoreText, scorePosition);
-
-		sfFloatRect maxScoreBounds = sfText_getLocalBounds(hud->maxScoreText);
-		sfText_setOrigin(hud->maxScoreText, (sfVector2f) { maxScoreBounds.width / 2, maxScoreBounds.height / 2 });
+		dirty |= HUD_DIRTY_MAX_SCORE;
 	}
-	else
+	if (_state->isButtonHovered != hud->shownHover)
+	{
+		dirty |= HUD_DIRTY_BUTTON;
+	}
+	if (lifeWidth != hud->shownLifeWidth)
 	{
-		sfFloatRect scoreSize = sfText_getLocalBounds(hud->scoreText);
-		sfText_setOrigin(hud->scoreText, (sfVector2f) { (float)scoreSize.width / 2, scoreSize.height / 2 });
-		sfVector2f textScorePosition = { SCREEN_WIDTH / 2 , SCREEN_HEIGHT * 0.15f };
-		sfText_setPosition(hud->scoreText, textScorePosition);
+		dirty |= HUD_DIRTY_LIFE;
+	}
+	if (!dirty)
+	{
+		return;
+	}
 
+	if (dirty & HUD_DIRTY_SCORE)
+	{
+		sfVector2f scorePosition = gameState == GAME_OVER ? (sfVector2f) { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2.1f }
+			: (sfVector2f) { SCREEN_WIDTH / 2 , SCREEN_HEIGHT * 0.15f };
+		DigitTextSet(&hud->scoreText, &hud->digits, (uint64_t)_state->score, scorePosition);
+		hud->shownScore = _state->score;
+		hud->shownState = gameState;
+	}
+	if (dirty & HUD_DIRTY_MAX_SCORE)
+	{
+		DigitTextSet(&hud->maxScoreText, &hud->digits, (uint64_t)_state->maxScore, hud->maxScorePosition);
+		hud->shownMaxScore = _state->maxScore;
+	}
+	if (dirty & HUD_DIRTY_BUTTON)
+	{
+		sfSprite_setColor(hud->button, _state->isButtonHovered ? sfColor_fromRGB(255, 255, 255) : sfColor_fromRGB(180, 180, 180));
+		hud->shownHover = _state->isButtonHovered;
+	}
+	if (dirty & HUD_DIRTY_LIFE)
+	{
+		UpdateLifeBar(hud, lifeWidth);
+		hud->shownLifeWidth = lifeWidth;
 	}
+	hud->isLaidOut = sfTrue;
 }
 
-void CleanupHud(HUD* const _hud)
+void CleanupHud(HUD* const _hud, ResourceCache* const _resources)
 {
 	if (_hud->title) {
-		sfSprite_destroy(_hud->title);
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _hud->title);
 		_hud->title = NULL;
 	}
+	if (_hud->button) {
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _hud->button);
+		_hud->button = NULL;
+	}
 	if (_hud->gameOver) {
-		sfSprite_destroy(_hud->gameOver);
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _hud->gameOver);
 		_hud->gameOver = NULL;
 	}
 	if (_hud->timeContainer) {
-		sfSprite_destroy(_hud->timeContainer);
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _hud->timeContainer);
 		_hud->timeContainer = NULL;
 	}
 	if (_hud->timeBar) {
-		sfSprite_destroy(_hud->timeBar);
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _hud->timeBar);
 		_hud->timeBar = NULL;
 	}
-	if (_hud->scoreText) {
-		sfText_destroy(_hud->scoreText);
-		_hud->scoreText = NULL;
-	}
-	if (_hud->fpsText) {
-		sfText_destroy(_hud->fpsText);
-		_hud->fpsText = NULL;
-	}
-	if (_hud->maxScoreText) {
-		sfText_destroy(_hud->maxScoreText);
-		_hud->maxScoreText = NULL;
-	}
+	DigitTextDestroy(&_hud->scoreText);
+	DigitTextDestroy(&_hud->maxScoreText);
+	DigitFontDestroy(&_hud->digits);
+	ResourceRelease(_resources, _hud->font);
+	_hud->font = NULL;
 }
 
 #pragma region Menu
 
-void UpdateButton(float _dt, sfRenderWindow* const _renderWindow, GameData* const _gameData)
+void SetButtonHover(HUD* const _hud, int _x, int _y)
+{
+	// Event coordinates are window pixels, like the layout
+	_hud->isColiding = sfFloatRect_contains(&_hud->buttonRect, (float)_x, (float)_y);
+}
+
+void DrawButton(SpriteBatch* const _batch, HUD* const _hud)
 {
-	HUD* hud = &_gameData->hud;
-	GameState* gameState = &_gameData->gameState;
-	sfBool* isStarted = &_gameData->game.isGameStarted;
+	// The hover color is applied by UpdateHud
+	SpriteBatchAddSprite(_batch, LAYER_HUD, _hud->button);
+}
+
+#pragma endregion
 
-	sfVector2i mouse = sfMouse_getPositionRenderWindow(_renderWindow);
-	sfVector2i mousePos = { mouse.x, mouse.y };
+#pragma region Game
+void LoadGame(Game* const _game, int _truncCount, uint64_t _seed, const Atlas* const _atlas, ResourceCache* const _resources)
+{
+	LoadLevel(&_game->level, _truncCount, _atlas, _resources);
+	LoadPlayer(&_game->player, _atlas, _resources);
+	_game->seed = _seed;
+	_game->maxScore = 0;
+	GameBeginSession(_game);
+}
 
-	sfFloatRect rect = sfSprite_getGlobalBounds(hud->button);
-	if (sfFloatRect_contains(&rect, (float) mousePos.x, (float) mousePos.y))
+void GameBeginSession(Game* const _game)
+{
+	if (_game->isReplaying)
 	{
-		if (sfMouse_isButtonPressed(sfMouseLeft))
-		{
-			if (*gameState == MENU)
-			{
-				*gameState = GAME;
-				*isStarted = sfTrue;
-				sfMusic_play(_gameData->game.level.music);
-			}
-			else if (*gameState == GAME_OVER)
-			{
-				Reset(_gameData);
-			}
-		}
-		hud->isColiding = sfTrue;
+		ReplayPlayerStart(&_game->replayPlayer, &_game->replay, &_game->sim);
 	}
 	else
 	{
-		hud->isColiding = sfFalse;
+		SimSeed(&_game->sim, _game->seed, 0);
+		SimReset(&_game->sim, _game->level.truncCount);
+		if (_game->recordPrefix)
+		{
+			ReplayBegin(&_game->replay, _game->seed, _game->sim.height, _game->tickRate);
+		}
 	}
+	_game->pendingAction = SIM_NONE;
+	_game->session++;
 }
 
-void DrawButton(sfRenderWindow* const _renderWindow, HUD* const _hud)
+void GameEndSession(Game* const _game)
 {
-	if (_hud->isColiding)
+	if (_game->recordPrefix && _game->sim.isStarted)
 	{
-		sfSprite_setColor(_hud->button, sfColor_fromRGB(255, 255, 255));
-		sfRenderWindow_drawSprite(_renderWindow, _hud->button, NULL);
+		char path[512];
+		snprintf(path, sizeof(path), "%s%llu.tmr", _game->recordPrefix, (unsigned long long)_game->seed);
+		if (!ReplaySave(&_game->replay, path, _game->sim.tick))
+		{
+			printf("Could not write replay %s\n", path);
+		}
 	}
-	else
+}
+
+void GameStart(Game* const _game)
+{
+	if (_game->isReplaying || _game->sim.isStarted)
 	{
-		sfSprite_setColor(_hud->button, sfColor_fromRGB(180, 180, 180));
-		sfRenderWindow_drawSprite(_renderWindow, _hud->button, NULL);
+		return;
 	}
 
+	SimStart(&_game->sim);
+	_game->startTime = TimerTicks();
+	if (_game->recordPrefix)
+	{
+		ReplayRecord(&_game->replay, _game->sim.tick, REPLAY_START);
+	}
 }
 
-#pragma endregion
-
-#pragma region Game
-void LoadGame(Game* const _game)
+void GameChop(Game* const _game, SimAction _action, int64_t _time)
 {
-	LoadLevel(&_game->level);
-	LoadPlayer(&_game->player);
-	_game->isGameStarted = sfFalse;
-	_game->lifeTime = 5;
-	_game->score = 0;
-	_game->maxScore = 0;
+	if (!_game->isReplaying && !_game->sim.dead && !_game->player.isCutting && _game->pendingAction == SIM_NONE)
+	{
+		_game->player.isCutting = sfTrue;
+		_game->pendingAction = _action;
+		_game->pendingTime = _time;
+	}
 }
 
-void GameOnKeyPressed(sfKeyEvent _key, Game* const _game)
+void UpdateGame(float _dt, Game* const _game, GameState _gameState)
 {
-	switch (_key.code)
+	Simulation* const sim = &_game->sim;
+	int previousScore = sim->score;
+	sfBool wasDead = sim->dead;
+	SimAction action = _game->pendingAction;
+	_game->pendingAction = SIM_NONE;
+
+	if (_game->isReplaying)
 	{
-	case sfKeyQ:
-		if (!_game->player.dead && !_game->player.isCutting)
-		{
-			_game->player.isCutting = sfTrue;
-			_game->player.dir = -1;
-			CheckPlayerCollide(&_game->level, &_game->player);
-			if (!_game->player.dead)
-			{
-				_game->lifeTime += 0.2f;
-				_game->score++;
-				UpdateTruncTexture(&_game->level);
-				sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferCutting);
-				sfSound_play(_game->player.soundPlay);
-			}
-			CheckPlayerCollide(&_game->level, &_game->player);
-		}
-		break;
-	case sfKeyLeft:
-		if (!_game->player.dead && !_game->player.isCutting)
-		{
-			_game->player.isCutting = sfTrue;
-			_game->player.dir = -1;
-			CheckPlayerCollide(&_game->level, &_game->player);
-			if (!_game->player.dead)
-			{
-				_game->lifeTime += 0.2f;
-				_game->score++;
-				UpdateTruncTexture(&_game->level);
-				sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferCutting);
-				sfSound_play(_game->player.soundPlay);
-			}
-			CheckPlayerCollide(&_game->level, &_game->player);
-		}
-		break;
-	case sfKeyRight:
-		if (!_game->player.dead && !_game->player.isCutting)
-		{
-			_game->player.isCutting = sfTrue;
-			_game->player.dir = 1;
-			CheckPlayerCollide(&_game->level, &_game->player);
-			if (!_game->player.dead)
-			{
-				_game->lifeTime += 0.2f;
-				_game->score++;
-				UpdateTruncTexture(&_game->level);
-				sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferCutting);
-				sfSound_play(_game->player.soundPlay);
-			}
-			CheckPlayerCollide(&_game->level, &_game->player);
-		}
-	case sfKeyD:
-		if (!_game->player.dead && !_game->player.isCutting)
+		action = ReplayPlayerTick(&_game->replayPlayer, sim);
+		if (action != SIM_NONE)
 		{
 			_game->player.isCutting = sfTrue;
-			_game->player.dir = 1;
-			CheckPlayerCollide(&_game->level, &_game->player);
-			if (!_game->player.dead)
-			{
-				_game->lifeTime += 0.2f;
-				_game->score++;
-				UpdateTruncTexture(&_game->level);
-				sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferCutting);
-				sfSound_play(_game->player.soundPlay);
-			}
-			CheckPlayerCollide(&_game->level, &_game->player);
 		}
-		break;
-	default:
-		_game->isGameStarted = sfTrue;
-		break;
 	}
-}
+	else if (_game->recordPrefix && action != SIM_NONE)
+	{
+		ReplayRecord(&_game->replay, sim->tick, action == SIM_CHOP_LEFT ? REPLAY_CHOP_LEFT : REPLAY_CHOP_RIGHT);
+	}
 
-void UpdateGame(float _dt, Game* const _game, HUD* const _hud, GameState _gameState)
-{
-	PlayerUpdateAnimation(_dt, &_game->player);
-	if (_game->maxScore < _game->score)
+	SimStep(sim, action, _dt);
+	if (action != SIM_NONE)
+	{
+		_game->chopSequence++;
+		_game->chopInputTime = _game->isReplaying ? 0 : _game->pendingTime;
+		_game->chopApplyTime = TimerTicks();
+	}
+
+	if (sim->score != previousScore)
 	{
-		_game->maxScore = _game->score;
+		sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferCutting);
+		sfSound_play(_game->player.soundPlay);
 	}
-	if (_game->lifeTime == 0)
+	if (action != SIM_NONE && sim->dead && !wasDead)
 	{
-		_game->player.dead = sfTrue;
+		sfSound_setBuffer(_game->player.soundPlay, _game->player.soundBufferDeath);
+		sfSound_play(_game->player.soundPlay);
 	}
 
-	if (_gameState == GAME_OVER)
+	PlayerUpdateAnimation(_dt, &_game->player, sim);
+	if (_game->maxScore < sim->score)
 	{
-		_game->player.dead;
-		sfMusic_stop(_game->level.music);
+		_game->maxScore = sim->score;
 	}
 
-	if (!_game->player.dead)
+	if (_gameState == GAME_OVER)
 	{
-		UpdateLifeBar(_dt, _game, _hud, _game->isGameStarted);
+		sfMusic_stop(_game->level.music);
 	}
-	PlayerUpdateMovement(&_game->player);
 }
 
 #pragma region Level
-void LoadLevel(Level* const _level)
+void LoadLevel(Level* const _level, int _truncCount, const Atlas* const _atlas, ResourceCache* const _resources)
 {
 	sfVector2f backgroundPosition = { 0, 0 };
-	CreateSprite(&_level->background, backgroundPosition, "Assets/Sprites/Background.png");
+	CreateSprite(&_level->background, backgroundPosition, _atlas, "Background");
 
-	sfVector2f nill = { 0, 0 };
-	CreateSprite(&_level->baseLog, nill, "Assets/Sprites/Stump.png");
-	sfFloatRect baseLogSize = sfSprite_getGlobalBounds(_level->baseLog);
-	sfSprite_setOrigin(_level->baseLog, (sfVector2f) { (float)baseLogSize.width / 2, baseLogSize.height });
 	sfVector2f baseLogPosition = { SCREEN_WIDTH / 2, GROUND };
-	sfSprite_setPosition(_level->baseLog, baseLogPosition);
-
-	_level->texture.trunc1 = sfTexture_createFromFile("Assets/Sprites/Trunk1.png", NULL);
-	_level->texture.trunc2 = sfTexture_createFromFile("Assets/Sprites/Trunk2.png", NULL);
-	_level->texture.branchLeft = sfTexture_createFromFile("Assets/Sprites/BranchLeft.png", NULL);
-	_level->texture.branchRight = sfTexture_createFromFile("Assets/Sprites/BranchRight.png", NULL);
-
-	sfVector2u truncSize = sfTexture_getSize(_level->texture.trunc1);
-	CreateTrunc(&_level->trunc1, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-	CreateTrunc(&_level->trunc2, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-	CreateTrunc(&_level->trunc3, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-	CreateTrunc(&_level->trunc4, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-	CreateTrunc(&_level->trunc5, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-	CreateTrunc(&_level->trunc6, (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
-
-	sfSprite_setOrigin(_level->trunc1, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
-	sfSprite_setOrigin(_level->trunc2, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
-	sfSprite_setOrigin(_level->trunc3, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
-	sfSprite_setOrigin(_level->trunc4, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
-	sfSprite_setOrigin(_level->trunc5, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
-	sfSprite_setOrigin(_level->trunc6, (sfVector2f) { (float)truncSize.x / 2, truncSize.y });
+	sfVector2i baseLogSize = CreateSprite(&_level->baseLog, baseLogPosition, _atlas, "Stump");
 
-	AsigneTruncTexture(&_level->trunc1, rand() % 2, &_level->texture);
-	AsigneTruncTexture(&_level->trunc2, rand() % 2, &_level->texture);
-	AsigneTruncTexture(&_level->trunc3, rand() % 2, &_level->texture);
-	AsigneTruncTexture(&_level->trunc4, rand() % 2, &_level->texture);
-	AsigneTruncTexture(&_level->trunc5, rand() % 2, &_level->texture);
-	AsigneTruncTexture(&_level->trunc6, rand() % 2, &_level->texture);
+	_level->texture.atlas = _atlas;
+	_level->texture.trunc1 = AtlasFind(_atlas, "Trunk1");
+	_level->texture.trunc2 = AtlasFind(_atlas, "Trunk2");
+	_level->texture.branchLeft = AtlasFind(_atlas, "BranchLeft");
+	_level->texture.branchRight = AtlasFind(_atlas, "BranchRight");
 
-	sfFloatRect baseLog = sfSprite_getGlobalBounds(_level->baseLog);
-	sfVector2f currentPosition = { SCREEN_WIDTH / 2, baseLog.top };
-
-	sfSprite_setPosition(_level->trunc1, currentPosition);
-
-	currentPosition.y -= truncSize.y;
-	sfSprite_setPosition(_level->trunc2, currentPosition);
-
-	currentPosition.y -= truncSize.y;
-	sfSprite_setPosition(_level->trunc3, currentPosition);
-
-	currentPosition.y -= truncSize.y;
-	sfSprite_setPosition(_level->trunc4, currentPosition);
-
-	currentPosition.y -= truncSize.y;
-	sfSprite_setPosition(_level->trunc5, currentPosition);
+	if (_truncCount < 1)
+	{
+		_truncCount = 1;
+	}
+	else if (_truncCount > MAX_TRUNC_COUNT)
+	{
+		_truncCount = MAX_TRUNC_COUNT;
+	}
+	_level->truncCount = _truncCount;
 
-	currentPosition.y -= truncSize.y;
-	sfSprite_setPosition(_level->trunc6, currentPosition);
+	// One sprite per ring slot, they are placed at draw time and get their origin with their frame
+	sfVector2i truncSize = _level->texture.trunc1->size;
+	for (int i = 0; i < _level->truncCount; i++)
+	{
+		CreateTrunc(&_level->trunc[i], (sfVector2f) { (float)truncSize.x, (float)truncSize.y });
+	}
 
+	_level->truncBase = (sfVector2f){ SCREEN_WIDTH / 2, baseLogPosition.y - baseLogSize.y };
+	_level->truncHeight = (float)truncSize.y;
 
-	_level->music = sfMusic_createFromFile("Assets/Musics/Theme.ogg");
+	size_t size = 0;
+	const void* theme = ResourceGetData(_resources, "Musics/Theme.ogg", &size);
+	CheckResource(_resources, "Musics/Theme.ogg", theme);
+	AssetStreamOpen(&_level->musicStream, theme, size);
+	_level->music = TRACK_CREATE(TRACK_MUSIC, sfMusic_createFromStream(&_level->musicStream.stream));
 	sfMusic_setVolume(_level->music, 40);
 	sfMusic_play(_level->music);
 }
 
-void DrawLevel(sfRenderWindow* const _renderWindow, Level* const _level)
+void DrawLevelStatic(SpriteBatch* const _batch, Level* const _level)
+{
+	// Never changes during a run, see DrawBackground
+	SpriteBatchAddSprite(_batch, LAYER_BACKGROUND, _level->background);
+	SpriteBatchAddSprite(_batch, LAYER_TREE, _level->baseLog);
+}
+
+void DrawLevel(SpriteBatch* const _batch, Level* const _level, const RenderState* const _state)
 {
-	sfRenderWindow_drawSprite(_renderWindow, _level->background, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->baseLog, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc1, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc2, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc3, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc4, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc5, NULL);
-	sfRenderWindow_drawSprite(_renderWindow, _level->trunc6, NULL);
+	// The segments are stacked without overlapping: one draw per trunk texture, whatever the height
+	sfVector2f position = _level->truncBase;
+	for (int i = 0; i < _state->truncCount; i++)
+	{
+		sfSprite* trunc = _level->trunc[(_level->truncHead + i) % _level->truncCount];
+		sfSprite_setPosition(trunc, position);
+		SpriteBatchAddSprite(_batch, LAYER_TREE, trunc);
+		position.y -= _level->truncHeight;
+	}
 }
 
-void CleanupLevel(Level* const _level)
+void CleanupLevel(Level* const _level, ResourceCache* const _resources)
 {
-	sfSprite_destroy(_level->background);
+	TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _level->background);
 	_level->background = NULL;
 
-	sfSprite_destroy(_level->baseLog);
+	TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _level->baseLog);
 	_level->baseLog = NULL;
 
-	sfSprite_destroy(_level->trunc1);
-	_level->trunc1 = NULL;
-
-	sfSprite_destroy(_level->trunc2);
-	_level->trunc2 = NULL;
-
-	sfSprite_destroy(_level->trunc3);
-	_level->trunc3 = NULL;
-
-	sfSprite_destroy(_level->trunc4);
-	_level->trunc4 = NULL;
-
-	sfSprite_destroy(_level->trunc5);
-	_level->trunc5 = NULL;
-
-	sfSprite_destroy(_level->trunc6);
-	_level->trunc6 = NULL;
-
-
-	sfTexture_destroy(_level->texture.trunc1);
-	_level->texture.trunc1 = NULL;
-
-	sfTexture_destroy(_level->texture.trunc2);
-	_level->texture.trunc2 = NULL;
-
-	sfTexture_destroy(_level->texture.branchLeft);
-	_level->texture.branchLeft = NULL;
+	for (int i = 0; i < _level->truncCount; i++)
+	{
+		TRACK_DESTROY(TRACK_SPRITE, sfSprite_destroy, _level->trunc[i]);
+		_level->trunc[i] = NULL;
+	}
 
-	sfTexture_destroy(_level->texture.branchRight);
-	_level->texture.branchRight = NULL;
+	// The trunk frames belong to the atlas
+	_level->texture = (TrunKTexture){ 0 };
 
 	sfMusic_stop(_level->music);
-	sfMusic_destroy(_level->music);
+	TRACK_DESTROY(TRACK_MUSIC, sfMusic_destroy, _level->music);
 	_level->music = NULL;
+	// Only once the music stopped reading it
+	ResourceRelease(_resources, _level->musicStream.data);
+	_level->musicStream = (AssetStream){ 0 };
 }
 
-void CheckPlayerCollide(Level* const _level, Player* const _player)
-{
-	const sfTexture* originalTexture;
-
-	originalTexture = sfSprite_getTexture(_level->trunc1);
-	if (originalTexture != NULL)
-	{
-		if (originalTexture == _level->texture.branchLeft)
-		{
-			if (_player->dir == -1)
-			{
-				_player->dead = sfTrue;
-			}
-		}
-		else if (originalTexture == _level->texture.branchRight)
-		{
-			if (_player->dir == 1)
-			{
-				_player->dead = sfTrue;
-			}
-		}
-	}
-
-	if (_player->dead)
-	{
-		sfSound_setBuffer(_player->soundPlay, _player->soundBufferDeath);
-		sfSound_play(_player->soundPlay);
-	}
-}
-
-void UpdateLifeBar(float _dt, Game* const _game, HUD* const _hud, sfBool _isStarted)
+void UpdateLifeBar(HUD* const _hud, int _width)
 {
-	if (_isStarted)
-	{
-		_game->lifeTime -= _dt;
-	}
-
-	if (_game->lifeTime < 0)
-	{
-		_game->lifeTime = 0;
-	}
-	else if (_game->lifeTime > MAX_LIFE_TIME)
-	{
-		_game->lifeTime = MAX_LIFE_TIME;
-	}
 	sfIntRect area = sfSprite_getTextureRect(_hud->timeBar);
-	sfVector2u size = sfTexture_getSize(sfSprite_getTexture(_hud->timeBar));
-
-	area.width = size.x * (_game->lifeTime / (float)MAX_LIFE_TIME);
-
+	area.width = _width;
 	sfSprite_setTextureRect(_hud->timeBar, area);
 }
 
 void CreateTrunc(sfSprite** const _sprite, sfVector2f position)
 {
-	*_sprite = sfSprite_create();
+	*_sprite = TRACK_CREATE(TRACK_SPRITE, sfSprite_create());
 	sfSprite_setPosition(*_sprite, position);
 }
 
 void AsigneTruncTexture(sfSprite** const _sprite, TruncType _truncType, TrunKTexture* _texture)
 {
+	// Every trunk frame is in the same page, only the rect and the origin change
 	switch (_truncType)
 	{
 	case NORMAL:
-		sfSprite_setTexture(*_sprite, _texture->trunc1, sfTrue);
+		AtlasSetSprite(*_sprite, _texture->atlas, _texture->trunc1, 0);
 		break;
 	case NORMAL2:
-		sfSprite_setTexture(*_sprite, _texture->trunc2, sfTrue);
+		AtlasSetSprite(*_sprite, _texture->atlas, _texture->trunc2, 0);
 		break;
 	case LEFT:
-		sfSprite_setTexture(*_sprite, _texture->branchLeft, sfTrue);
+		AtlasSetSprite(*_sprite, _texture->atlas, _texture->branchLeft, 0);
 		break;
 	case RIGHT:
-		sfSprite_setTexture(*_sprite, _texture->branchRight, sfTrue);
+		AtlasSetSprite(*_sprite, _texture->atlas, _texture->branchRight, 0);
 		break;
 	default:
 		break;
 	}
 }
 
-void UpdateTruncTexture(Level* const _level)
+void UpdateTrunc(Level* const _level, const RenderState* const _state)
 {
-	const sfTexture* originalTexture;
-
-	// Trunc2 -> Trunc1
-	originalTexture = sfSprite_getTexture(_level->trunc2);
-	if (originalTexture != NULL)
-	{
-		sfSprite_setTexture(_level->trunc1, originalTexture, sfTrue);
-	}
-
-	originalTexture = sfSprite_getTexture(_level->trunc3);
-	if (originalTexture != NULL)
-	{
-		sfSprite_setTexture(_level->trunc2, originalTexture, sfTrue);
-	}
-
-	originalTexture = sfSprite_getTexture(_level->trunc4);
-	if (originalTexture != NULL)
+	// Several chops can happen between two rendered frames
+	int chopCount = _state->score - _level->truncScore;
+	if (_state->session != _level->truncSession || chopCount < 0 || chopCount >= _state->truncCount)
 	{
-		sfSprite_setTexture(_level->trunc3, originalTexture, sfTrue);
+		ResetTruncTexture(_level, _state);
 	}
-
-	originalTexture = sfSprite_getTexture(_level->trunc5);
-	if (originalTexture != NULL)
+	else if (chopCount > 0)
 	{
-		sfSprite_setTexture(_level->trunc4, originalTexture, sfTrue);
+		UpdateTruncTexture(_level, _state, chopCount);
 	}
+	_level->truncSession = _state->session;
+	_level->truncScore = _state->score;
+}
 
-	originalTexture = sfSprite_getTexture(_level->trunc6);
-	if (originalTexture != NULL)
+void UpdateTruncTexture(Level* const _level, const RenderState* const _state, int _chopCount)
+{
+	// The sprites form a ring: the chopped ones are reused as the new top segments
+	for (int i = 0; i < _chopCount; i++)
 	{
-		sfSprite_setTexture(_level->trunc5, originalTexture, sfTrue);
+		int top = _level->truncHead;
+		_level->truncHead = (_level->truncHead + 1) % _level->truncCount;
+		AsigneTruncTexture(&_level->trunc[top], _state->trunc[_state->truncCount - _chopCount + i], &_level->texture);
 	}
+}
 
-	if (originalTexture == _level->texture.branchLeft || originalTexture == _level->texture.branchRight)
-	{
-		AsigneTruncTexture(&_level->trunc6, rand() % 2, &_level->texture);
-	}
-	else
+void ResetTruncTexture(Level* const _level, const RenderState* const _state)
+{
+	_level->truncHead = 0;
+	for (int i = 0; i < _state->truncCount; i++)
 	{
-		AsigneTruncTexture(&_level->trunc6, rand() % 4, &_level->texture);
+		AsigneTruncTexture(&_level->trunc[i], _state->trunc[i], &_level->texture);
 	}
 }
 
@@ -1028,71 +2104,73 @@ void UpdateTruncTexture(Level* const _level)
 
 #pragma region Player
 
-void LoadPlayer(Player* const _player)
+void LoadPlayer(Player* const _player, const Atlas* const _atlas, ResourceCache* const _resources)
 {
-	_player->dir = BASE_POSITION;
 	_player->animationTime = 0;
-	LoadPlayerAnimations(_player);
+	LoadPlayerAnimations(_player, _atlas);
 	_player->animation.currentAnim = &_player->animation.idle;
 
-	sfFloatRect box = sfSprite_getGlobalBounds(_player->animation.currentAnim->sprite);
-	sfVector2f position = { SCREEN_WIDTH - box.width / 2 , GROUND };
+	sfVector2i size = _player->animation.currentAnim->sheet->size;
+	sfVector2f position = { SCREEN_WIDTH - size.x / 2.f , GROUND };
 	sfSprite_setPosition(_player->animation.currentAnim->sprite, position);
 	sfSprite_setScale(_player->animation.currentAnim->sprite, (sfVector2f) { -1, 1 });
 
-	_player->soundBufferCutting = sfSoundBuffer_createFromFile("Assets/Sounds/Cut.ogg");
-	_player->soundBufferDeath = sfSoundBuffer_createFromFile("Assets/Sounds/Death.ogg");
+	_player->soundBufferCutting = ResourceGetSoundBuffer(_resources, "Sounds/Cut.ogg");
+	CheckResource(_resources, "Sounds/Cut.ogg", _player->soundBufferCutting);
+	_player->soundBufferDeath = ResourceGetSoundBuffer(_resources, "Sounds/Death.ogg");
+	CheckResource(_resources, "Sounds/Death.ogg", _player->soundBufferDeath);
 
-	_player->soundPlay = sfSound_create();
+	_player->soundPlay = TRACK_CREATE(TRACK_SOUND, sfSound_create());
 }
 
-void LoadPlayerAnimations(Player* const _player)
+void LoadPlayerAnimations(Player* const _player, const Atlas* const _atlas)
 {
-	sfTexture* idle = sfTexture_createFromFile("Assets/Sprites/ManIdle.png", NULL);
-	sfTexture* cut = sfTexture_createFromFile("Assets/Sprites/ManWoodcutting.png", NULL);
-	sfTexture* dead = sfTexture_createFromFile("Assets/Sprites/RIP.png", NULL);
-	SetupAnimation(&_player->animation.idle, &idle, 2, 4, sfTrue);
-	SetupAnimation(&_player->animation.woodcutting, &cut, 2, 20, sfFalse);
-	SetupAnimation(&_player->animation.dead, &dead, 1, 1, sfFalse);
+	// Frame counts are in the atlas metadata, only the speeds are game rules
+	SetupAnimation(&_player->animation.idle, _atlas, "ManIdle", 4, sfTrue);
+	SetupAnimation(&_player->animation.woodcutting, _atlas, "ManWoodcutting", 20, sfFalse);
+	SetupAnimation(&_player->animation.dead, _atlas, "RIP", 1, sfFalse);
 }
 
-void PlayerUpdateMovement(Player* const _player)
+void PlayerUpdateMovement(Player* const _player, const RenderState* const _state)
 {
-	sfFloatRect box = sfSprite_getGlobalBounds(_player->animation.currentAnim->sprite);
-	if (!_player->dead)
+	sfSprite* const sprite = _state->playerAnimation->sprite;
+	// The untrimmed frame, the trimmed bounds change from one frame to the next
+	sfVector2i size = _state->playerAnimation->sheet->size;
+	sfFloatRect box = { 0, 0, (float)size.x, (float)size.y };
+	if (!_state->isDead)
 	{
-		if (_player->dir == 1)
+		if (_state->dir == 1)
 		{
 			sfVector2f position = { SCREEN_WIDTH - box.width / 2 , GROUND };
-			sfSprite_setPosition(_player->animation.currentAnim->sprite, position);
-			sfSprite_setScale(_player->animation.currentAnim->sprite, (sfVector2f) { -1, 1 });
+			sfSprite_setPosition(sprite, position);
+			sfSprite_setScale(sprite, (sfVector2f) { -1, 1 });
 		}
 		else
 		{
 			sfVector2f position = { 0 + box.width / 2, GROUND };
-			sfSprite_setPosition(_player->animation.currentAnim->sprite, position);
-			sfSprite_setScale(_player->animation.currentAnim->sprite, (sfVector2f) { 1, 1 });
+			sfSprite_setPosition(sprite, position);
+			sfSprite_setScale(sprite, (sfVector2f) { 1, 1 });
 		}
 
 	}
 	else
 	{
-		if (_player->dir == 1)
+		if (_state->dir == 1)
 		{
 			sfVector2f position = { SCREEN_WIDTH * 1.1f - box.height, GROUND };
-			sfSprite_setPosition(_player->animation.currentAnim->sprite, position);
+			sfSprite_setPosition(sprite, position);
 		}
 		else
 		{
 			sfVector2f position = { SCREEN_WIDTH / 2.5f - box.height, GROUND };
-			sfSprite_setPosition(_player->animation.currentAnim->sprite, position);
+			sfSprite_setPosition(sprite, position);
 		}
 	}
 }
 
-void PlayerUpdateAnimation(float _dt, Player* const _player)
+void PlayerUpdateAnimation(float _dt, Player* const _player, const Simulation* const _sim)
 {
-	if (!_player->dead)
+	if (!_sim->dead)
 	{
 		if (_player->isCutting)
 		{
@@ -1122,12 +2200,12 @@ void PlayerUpdateAnimation(float _dt, Player* const _player)
 	}
 }
 
-void DrawPlayer(sfRenderWindow* const _renderWindow, Player* const _player)
+void DrawPlayer(SpriteBatch* const _batch, Animation* const _animation)
 {
-	sfRenderWindow_drawSprite(_renderWindow, _player->animation.currentAnim->sprite, NULL);
+	SpriteBatchAddSprite(_batch, LAYER_PLAYER, _animation->sprite);
 }
 
-void CleanupPlayer(Player* const _player)
+void CleanupPlayer(Player* const _player, ResourceCache* const _resources)
 {
 	if (!_player)
 	{
@@ -1139,15 +2217,16 @@ void CleanupPlayer(Player* const _player)
 	cleanupAnimation(&_player->animation.woodcutting);
 	cleanupAnimation(&_player->animation.dead);
 
-	sfSoundBuffer_destroy(_player->soundBufferCutting);
+	// The sound may still play one of the buffers
+	TRACK_DESTROY(TRACK_SOUND, sfSound_destroy, _player->soundPlay);
+	_player->soundPlay = NULL;
+
+	ResourceRelease(_resources, _player->soundBufferCutting);
 	_player->soundBufferCutting = NULL;
 
-	sfSoundBuffer_destroy(_player->soundBufferDeath);
+	ResourceRelease(_resources, _player->soundBufferDeath);
 	_player->soundBufferDeath = NULL;
 
-	sfSound_destroy(_player->soundPlay);
-	_player->soundPlay = NULL;
-
 }
 #pragma endregion
 #pragma endregion
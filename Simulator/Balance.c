@@ -0,0 +1,311 @@
+#include <stdlib.h>
+#include <string.h>
+#include "Balance.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#pragma region Define
+#define PERCENTILE_COUNT 6
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct BalanceWorker
+{
+	Thread thread;
+	const SimConfig* config;
+	const SolverPolicy* policy;
+	int index;
+	int threadCount;
+	long long gameCount;
+	uint64_t seed;
+	uint32_t maxTicks;
+
+	long long stuckCount;
+	double totalScore;
+	double totalSeconds;
+	int maxScore;
+	long long* scoreCounts;
+}BalanceWorker;
+#pragma endregion
+
+// Perfect play is capped by the cutting animation (2 frames at 20 fps),
+// the others are rough human reaction times
+static const SolverPolicy policies[] =
+{
+	{ "perfect", 0.1f, 0.f, 0.1f, 0.f },
+	{ "expert", 0.14f, 0.03f, 0.1f, 0.001f },
+	{ "casual", 0.18f, 0.05f, 0.1f, 0.005f },
+	{ "novice", 0.25f, 0.08f, 0.1f, 0.02f },
+};
+
+static const double percentiles[PERCENTILE_COUNT] = { 10, 25, 50, 75, 90, 99 };
+
+int BalancePolicyCount(void)
+{
+	return (int)(sizeof(policies) / sizeof(policies[0]));
+}
+
+const SolverPolicy* BalanceGetPolicy(int _index)
+{
+	return &policies[_index];
+}
+
+const SolverPolicy* BalanceFindPolicy(const char* _name)
+{
+	for (int i = 0; i < BalancePolicyCount(); i++)
+	{
+		if (strcmp(policies[i].name, _name) == 0)
+		{
+			return &policies[i];
+		}
+	}
+	return NULL;
+}
+
+static void BalanceWorkerRun(void* _worker)
+{
+	BalanceWorker* worker = _worker;
+	Random simRandom;
+	Random policyRandom;
+	RandomSeed(&simRandom, worker->seed);
+	RandomSeed(&policyRandom, worker->seed ^ BALANCE_POLICY_SEED);
+	for (int i = 0; i < worker->index; i++)
+	{
+		RandomJump(&simRandom);
+		RandomJump(&policyRandom);
+	}
+
+	// Accumulated locally, the worker struct is only written once at the end
+	long long stuckCount = 0;
+	double totalScore = 0;
+	uint64_t totalTicks = 0;
+	int maxScore = 0;
+
+	long long chunkCount = (worker->gameCount + BALANCE_CHUNK_GAMES - 1) / BALANCE_CHUNK_GAMES;
+	for (long long chunk = worker->index; chunk < chunkCount; chunk += worker->threadCount)
+	{
+		Simulation sim;
+		sim.random = simRandom;
+		sim.config = *worker->config;
+		Random random = policyRandom;
+
+		long long end = (chunk + 1) * BALANCE_CHUNK_GAMES;
+		if (end > worker->gameCount)
+		{
+			end = worker->gameCount;
+		}
+		for (long long game = chunk * BALANCE_CHUNK_GAMES; game < end; game++)
+		{
+			SimReset(&sim, DEFAULT_TRUNC_COUNT);
+			SolverResult result = SolverPlay(&sim, worker->policy, &random, BALANCE_TICK_RATE, worker->maxTicks);
+
+			worker->scoreCounts[result.score]++;
+			totalScore += result.score;
+			totalTicks += result.ticks;
+			stuckCount += result.isStuck;
+			if (result.score > maxScore)
+			{
+				maxScore = result.score;
+			}
+		}
+
+		for (int i = 0; i < worker->threadCount; i++)
+		{
+			RandomJump(&simRandom);
+			RandomJump(&policyRandom);
+		}
+	}
+
+	worker->stuckCount = stuckCount;
+	worker->totalScore = totalScore;
+	worker->totalSeconds = (double)totalTicks / BALANCE_TICK_RATE;
+	worker->maxScore = maxScore;
+}
+
+bool BalanceRun(BalanceResult* const _result, const SimConfig* const _config, const SolverPolicy* const _policy,
+	long long _gameCount, int _threadCount, uint64_t _seed, float _maxSeconds)
+{
+	memset(_result, 0, sizeof(*_result));
+	_result->config = *_config;
+	_result->policy = _policy;
+	_result->gameCount = _gameCount;
+
+	// At most one chop per tick, so the score can never exceed the tick count
+	uint32_t maxTicks = (uint32_t)(_maxSeconds * BALANCE_TICK_RATE);
+	_result->countSize = maxTicks + 1;
+	_result->scoreCounts = calloc(_result->countSize, sizeof(long long));
+	BalanceWorker* workers = calloc(_threadCount, sizeof(BalanceWorker));
+	if (!_result->scoreCounts || !workers)
+	{
+		free(workers);
+		BalanceFree(_result);
+		return false;
+	}
+
+	double start = TimerNow();
+	int startedCount = 0;
+	for (int i = 0; i < _threadCount; i++)
+	{
+		BalanceWorker* worker = &workers[i];
+		worker->config = _config;
+		worker->policy = _policy;
+		worker->index = i;
+		worker->threadCount = _threadCount;
+		worker->gameCount = _gameCount;
+		worker->seed = _seed;
+		worker->maxTicks = maxTicks;
+		worker->scoreCounts = calloc(_result->countSize, sizeof(long long));
+		if (!worker->scoreCounts)
+		{
+			break;
+		}
+
+		// The calling thread plays the last share itself
+		if (i == _threadCount - 1)
+		{
+			BalanceWorkerRun(worker);
+		}
+		else if (!ThreadStart(&worker->thread, BalanceWorkerRun, worker))
+		{
+			free(worker->scoreCounts);
+			break;
+		}
+		startedCount++;
+	}
+
+	bool isComplete = startedCount == _threadCount;
+	for (int i = 0; i < startedCount; i++)
+	{
+		BalanceWorker* worker = &workers[i];
+		if (i != _threadCount - 1)
+		{
+			ThreadWait(&worker->thread);
+		}
+
+		for (int score = 0; score < _result->countSize; score++)
+		{
+			_result->scoreCounts[score] += worker->scoreCounts[score];
+		}
+		_result->stuckCount += worker->stuckCount;
+		_result->totalScore += worker->totalScore;
+		_result->totalSeconds += worker->totalSeconds;
+		if (worker->maxScore > _result->maxScore)
+		{
+			_result->maxScore = worker->maxScore;
+		}
+		free(worker->scoreCounts);
+	}
+	_result->runSeconds = TimerNow() - start;
+
+	free(workers);
+	if (!isComplete)
+	{
+		BalanceFree(_result);
+	}
+	return isComplete;
+}
+
+void BalanceFree(BalanceResult* const _result)
+{
+	free(_result->scoreCounts);
+	_result->scoreCounts = NULL;
+	_result->countSize = 0;
+}
+
+int BalancePercentile(const BalanceResult* const _result, double _percent)
+{
+	// Nearest rank
+	long long rank = (long long)(_percent / 100.0 * _result->gameCount + 0.999999);
+	if (rank < 1)
+	{
+		rank = 1;
+	}
+
+	long long seen = 0;
+	for (int score = 0; score < _result->countSize; score++)
+	{
+		seen += _result->scoreCounts[score];
+		if (seen >= rank)
+		{
+			return score;
+		}
+	}
+	return _result->maxScore;
+}
+
+static long long BinCount(const BalanceResult* const _result, int _bin, int _binWidth)
+{
+	long long count = 0;
+	for (int score = _bin * _binWidth; score < (_bin + 1) * _binWidth && score < _result->countSize; score++)
+	{
+		count += _result->scoreCounts[score];
+	}
+	return count;
+}
+
+void BalanceWriteCsv(FILE* _file, const BalanceResult* const _results, int _count, int _binWidth)
+{
+	fprintf(_file, "start_life,life_bonus,max_life,branch_chance,policy,games,mean_score,mean_seconds,max_score,stuck");
+	for (int p = 0; p < PERCENTILE_COUNT; p++)
+	{
+		fprintf(_file, ",p%g", percentiles[p]);
+	}
+	fprintf(_file, "\n");
+
+	for (int i = 0; i < _count; i++)
+	{
+		const BalanceResult* result = &_results[i];
+		const SimConfig* config = &result->config;
+		fprintf(_file, "%g,%g,%g,%g,%s,%lld,%.3f,%.3f,%d,%lld", config->startLifeTime, config->lifeBonus,
+			config->maxLifeTime, config->branchChance, result->policy->name, result->gameCount,
+			result->totalScore / result->gameCount, result->totalSeconds / result->gameCount,
+			result->maxScore, result->stuckCount);
+		for (int p = 0; p < PERCENTILE_COUNT; p++)
+		{
+			fprintf(_file, ",%d", BalancePercentile(result, percentiles[p]));
+		}
+		fprintf(_file, "\n");
+	}
+
+	// Second table: the histograms, one row per bin
+	fprintf(_file, "\nstart_life,life_bonus,max_life,branch_chance,policy,score_min,score_max,count\n");
+	for (int i = 0; i < _count; i++)
+	{
+		const BalanceResult* result = &_results[i];
+		const SimConfig* config = &result->config;
+		for (int bin = 0; bin <= result->maxScore / _binWidth; bin++)
+		{
+			fprintf(_file, "%g,%g,%g,%g,%s,%d,%d,%lld\n", config->startLifeTime, config->lifeBonus,
+				config->maxLifeTime, config->branchChance, result->policy->name,
+				bin * _binWidth, (bin + 1) * _binWidth - 1, BinCount(result, bin, _binWidth));
+		}
+	}
+}
+
+void BalanceWriteJson(FILE* _file, const BalanceResult* const _results, int _count, int _binWidth)
+{
+	fprintf(_file, "{\n\t\"tickRate\": %d,\n\t\"binWidth\": %d,\n\t\"runs\": [", BALANCE_TICK_RATE, _binWidth);
+	for (int i = 0; i < _count; i++)
+	{
+		const BalanceResult* result = &_results[i];
+		const SimConfig* config = &result->config;
+		fprintf(_file, "%s\n\t\t{\n", i ? "," : "");
+		fprintf(_file, "\t\t\t\"startLifeTime\": %g,\n\t\t\t\"lifeBonus\": %g,\n\t\t\t\"maxLifeTime\": %g,\n\t\t\t\"branchChance\": %g,\n",
+			config->startLifeTime, config->lifeBonus, config->maxLifeTime, config->branchChance);
+		fprintf(_file, "\t\t\t\"policy\": \"%s\",\n\t\t\t\"games\": %lld,\n\t\t\t\"meanScore\": %.3f,\n\t\t\t\"meanSeconds\": %.3f,\n",
+			result->policy->name, result->gameCount, result->totalScore / result->gameCount,
+			result->totalSeconds / result->gameCount);
+		fprintf(_file, "\t\t\t\"maxScore\": %d,\n\t\t\t\"stuck\": %lld,\n\t\t\t\"percentiles\": {", result->maxScore, result->stuckCount);
+		for (int p = 0; p < PERCENTILE_COUNT; p++)
+		{
+			fprintf(_file, "%s\"p%g\": %d", p ? ", " : " ", percentiles[p], BalancePercentile(result, percentiles[p]));
+		}
+		fprintf(_file, " },\n\t\t\t\"histogram\": [");
+		for (int bin = 0; bin <= result->maxScore / _binWidth; bin++)
+		{
+			fprintf(_file, "%s%lld", bin ? ", " : "", BinCount(result, bin, _binWidth));
+		}
+		fprintf(_file, "]\n\t\t}");
+	}
+	fprintf(_file, "\n\t]\n}\n");
+}
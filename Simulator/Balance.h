@@ -0,0 +1,48 @@
+#pragma once
+#include <stdbool.h>
+#include <stdio.h>
+#include "Simulation.h"
+#include "Solver.h"
+
+// Monte Carlo balancing: plays many games of one SimConfig with one policy.
+// Games are cut into chunks that each own a Random stream, so the results
+// only depend on the seed, never on the thread count. Threads share nothing
+// until their histograms are merged at the end.
+
+#pragma region Define
+#define BALANCE_TICK_RATE 120
+#define BALANCE_CHUNK_GAMES 1024
+#define BALANCE_POLICY_SEED 0x9E3779B97F4A7C15ull
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef struct BalanceResult
+{
+	SimConfig config;
+	const SolverPolicy* policy;
+	long long gameCount;
+	long long stuckCount;
+	double totalScore;
+	double totalSeconds;
+	int maxScore;
+	// Number of games per final score
+	long long* scoreCounts;
+	int countSize;
+	// Wall clock time of the run
+	double runSeconds;
+}BalanceResult;
+#pragma endregion
+
+#pragma region Definition
+int BalancePolicyCount(void);
+const SolverPolicy* BalanceGetPolicy(int _index);
+const SolverPolicy* BalanceFindPolicy(const char* _name);
+
+bool BalanceRun(BalanceResult* const _result, const SimConfig* const _config, const SolverPolicy* const _policy,
+	long long _gameCount, int _threadCount, uint64_t _seed, float _maxSeconds);
+void BalanceFree(BalanceResult* const _result);
+int BalancePercentile(const BalanceResult* const _result, double _percent);
+
+void BalanceWriteCsv(FILE* _file, const BalanceResult* const _results, int _count, int _binWidth);
+void BalanceWriteJson(FILE* _file, const BalanceResult* const _results, int _count, int _binWidth);
+#pragma endregion
@@ -0,0 +1,714 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Simulation.h"
+#include "SimBatch.h"
+#include "Replay.h"
+#include "Solver.h"
+#include "Balance.h"
+#include "File.h"
+#include "Thread.h"
+#include "Job.h"
+#include "Timer.h"
+
+#pragma region Define
+#define DEFAULT_GAME_COUNT 1000000
+#define DEFAULT_BATCH_COUNT 65536
+#define DEFAULT_BATCH_STEPS 2000
+#define SIM_DT (1.f / 60.f)
+#define DEFAULT_SEED 1
+#define DEFAULT_SOLVER_GAMES 1000
+#define SOLVER_TICK_RATE 120
+#define SOLVER_MAX_SECONDS 600
+#define DEFAULT_BALANCE_GAMES 100000
+#define DEFAULT_BALANCE_SECONDS 120
+#define DEFAULT_BIN_WIDTH 10
+#define MAX_SWEEP_VALUES 16
+#define DEFAULT_JOB_COUNT 1000000
+#define JOB_BATCH_COUNT 1024
+#define JOB_FRAME_COUNT 100000
+#pragma endregion
+
+#pragma region Definition
+void RunBench(long long _gameCount);
+void RunBatchBench(int _gameCount, int _stepCount);
+void RunBatchPath(SimBatchPath _path, int _gameCount, int _stepCount);
+int RunReplay(const char* _path, bool _printHashes);
+int RunSolver(int _gameCount, bool _isBatch);
+void RunSolverBatch(int _gameCount, int _stepCount);
+bool RunSolverRate(const SimConfig* const _config, float _chopRate, int _gameCount);
+int RunBalance(int argc, char** argv);
+int ParseList(const char* _text, float* const _values);
+bool ParseNumber(const char* _text, float* const _value);
+bool ParseSeed(const char* _text, uint64_t* const _seed);
+int RunJobBench(int _jobCount, int _workerCount);
+bool ParseCount(const char* _text, long long* const _count);
+bool ParseIntCount(const char* _text, int* const _count);
+void PrintUsage(void);
+#pragma endregion
+
+#pragma region Core
+int main(int argc, char** argv)
+{
+	if (argc > 2 && strcmp(argv[1], "replay") == 0)
+	{
+		bool printHashes = argc > 3 && strcmp(argv[3], "--hashes") == 0;
+		return RunReplay(argv[2], printHashes);
+	}
+	else if (argc > 1 && strcmp(argv[1], "solve") == 0)
+	{
+		int gameCount = DEFAULT_SOLVER_GAMES;
+		bool isBatch = false;
+		for (int i = 2; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--batch") == 0)
+			{
+				isBatch = true;
+			}
+			else if (!ParseIntCount(argv[i], &gameCount))
+			{
+				PrintUsage();
+				return EXIT_FAILURE;
+			}
+		}
+		return RunSolver(gameCount, isBatch);
+	}
+	else if (argc > 1 && strcmp(argv[1], "balance") == 0)
+	{
+		return RunBalance(argc, argv);
+	}
+	else if (argc > 1 && strcmp(argv[1], "jobs") == 0)
+	{
+		int jobCount = argc > 2 ? atoi(argv[2]) : DEFAULT_JOB_COUNT;
+		return RunJobBench(jobCount, argc > 3 ? atoi(argv[3]) : 0);
+	}
+	else if (argc > 1 && strcmp(argv[1], "batch") == 0)
+	{
+		int gameCount = DEFAULT_BATCH_COUNT;
+		int stepCount = DEFAULT_BATCH_STEPS;
+		if (argc > 4 || (argc > 2 && !ParseIntCount(argv[2], &gameCount)) || (argc > 3 && !ParseIntCount(argv[3], &stepCount)))
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+		RunBatchBench(gameCount, stepCount);
+	}
+	else if (argc > 1 && strcmp(argv[1], "bench") == 0)
+	{
+		long long gameCount = DEFAULT_GAME_COUNT;
+		if (argc > 3 || (argc > 2 && !ParseCount(argv[2], &gameCount)))
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+		RunBench(gameCount);
+	}
+	else
+	{
+		// The command line from before the subcommands: nothing, or only the game count
+		long long gameCount = DEFAULT_GAME_COUNT;
+		if (argc > 2 || (argc > 1 && !ParseCount(argv[1], &gameCount)))
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+		RunBench(gameCount);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+bool ParseCount(const char* _text, long long* const _count)
+{
+	char* end = NULL;
+	long long count = strtoll(_text, &end, 10);
+	if (end == _text || *end != '\0' || count <= 0)
+	{
+		return false;
+	}
+	*_count = count;
+	return true;
+}
+
+bool ParseIntCount(const char* _text, int* const _count)
+{
+	long long count = 0;
+	if (!ParseCount(_text, &count) || count > INT_MAX)
+	{
+		return false;
+	}
+	*_count = (int)count;
+	return true;
+}
+
+void PrintUsage(void)
+{
+	printf("usage: Simulator [bench] [games]\n");
+	printf("usage: Simulator batch [games] [steps]\n");
+	printf("usage: Simulator solve [games] [--batch]\n");
+	printf("usage: Simulator balance [options], see the README\n");
+	printf("usage: Simulator jobs [jobs] [workers]\n");
+	printf("usage: Simulator replay <file> [--hashes]\n");
+}
+
+void RunBench(long long _gameCount)
+{
+	Simulation sim;
+	Random policy;
+	long long chopCount = 0;
+	long long bestScore = 0;
+
+	SimSeed(&sim, DEFAULT_SEED, 0);
+	RandomSeed(&policy, DEFAULT_SEED + 1);
+
+	clock_t start = clock();
+	for (long long i = 0; i < _gameCount; i++)
+	{
+		SimReset(&sim, DEFAULT_TRUNC_COUNT);
+		SimStart(&sim);
+		while (!sim.dead)
+		{
+			SimStep(&sim, RandomNext(&policy) >> 31 ? SIM_CHOP_LEFT : SIM_CHOP_RIGHT, SIM_DT);
+			chopCount++;
+		}
+		if (sim.score > bestScore)
+		{
+			bestScore = sim.score;
+		}
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("games: %lld\n", _gameCount);
+	printf("chops: %lld\n", chopCount);
+	printf("best score: %lld\n", bestScore);
+	printf("time: %.3f s\n", seconds);
+	if (seconds > 0)
+	{
+		printf("chops/s: %.0f\n", chopCount / seconds);
+	}
+}
+
+void RunBatchBench(int _gameCount, int _stepCount)
+{
+	SimBatchPath best = SimBatchDetectPath();
+	printf("cpu path: %s\n", SimBatchPathName(best));
+	for (int path = SIM_BATCH_SCALAR; path <= (int)best; path++)
+	{
+		RunBatchPath(path, _gameCount, _stepCount);
+	}
+}
+
+void RunBatchPath(SimBatchPath _path, int _gameCount, int _stepCount)
+{
+	SimBatch batch;
+	if (!SimBatchCreate(&batch, _gameCount, DEFAULT_TRUNC_COUNT, DEFAULT_SEED))
+	{
+		printf("%s: allocation failed\n", SimBatchPathName(_path));
+		return;
+	}
+	batch.path = _path;
+	SimBatchStart(&batch);
+
+	long long finishedGames = 0;
+	long long totalScore = 0;
+	Random policy;
+	RandomSeed(&policy, DEFAULT_SEED + 1);
+
+	clock_t start = clock();
+	for (int step = 0; step < _stepCount; step++)
+	{
+		for (int i = 0; i < batch.count; i++)
+		{
+			batch.action[i] = (RandomNext(&policy) >> 16) % 3;
+		}
+
+		SimBatchStep(&batch, SIM_DT);
+
+		for (int i = 0; i < batch.count; i++)
+		{
+			if (batch.dead[i])
+			{
+				finishedGames++;
+				totalScore += batch.score[i];
+				SimBatchReset(&batch, i);
+				batch.isStarted[i] = -1;
+			}
+		}
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	long long gameSteps = (long long)batch.count * _stepCount;
+	printf("%s: %lld game steps, %lld games finished, avg score %.2f, %.3f s",
+		SimBatchPathName(_path), gameSteps, finishedGames,
+		finishedGames ? (double)totalScore / finishedGames : 0.0, seconds);
+	if (seconds > 0)
+	{
+		printf(", %.0f game steps/s", gameSteps / seconds);
+	}
+	printf("\n");
+
+	SimBatchDestroy(&batch);
+}
+
+int RunReplay(const char* _path, bool _printHashes)
+{
+	Replay replay = { 0 };
+	if (!ReplayLoad(&replay, _path))
+	{
+		printf("Could not read replay %s\n", _path);
+		return EXIT_FAILURE;
+	}
+
+	Simulation sim;
+	ReplayPlayer player;
+	float tickTime = 1.f / replay.tickRate;
+
+	clock_t start = clock();
+	ReplayPlayerStart(&player, &replay, &sim);
+	while (!ReplayPlayerIsFinished(&player, &sim))
+	{
+		SimAction action = ReplayPlayerTick(&player, &sim);
+		SimStep(&sim, action, tickTime);
+		if (_printHashes)
+		{
+			printf("%u %016llx\n", sim.tick, (unsigned long long)SimHash(&sim));
+		}
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("seed: %llu\n", (unsigned long long)replay.seed);
+	printf("events: %zu\n", replay.eventCount);
+	printf("ticks: %u\n", sim.tick);
+	printf("score: %d\n", sim.score);
+	printf("dead: %s\n", sim.dead ? "yes" : "no");
+	printf("hash: %016llx\n", (unsigned long long)SimHash(&sim));
+	if (seconds > 0)
+	{
+		printf("speed: %.0fx real time\n", sim.tick / (double)replay.tickRate / seconds);
+	}
+
+	ReplayFree(&replay);
+	return EXIT_SUCCESS;
+}
+
+int RunSolver(int _gameCount, bool _isBatch)
+{
+	// Decisions per second over a whole batch, a long run on its own
+	if (_isBatch)
+	{
+		RunSolverBatch(DEFAULT_BATCH_COUNT, DEFAULT_BATCH_STEPS);
+	}
+
+	// The game itself caps chops at one per cutting animation, about 10/s
+	static const float chopRates[] = { 3.f, 4.f, 4.5f, 5.f, 5.5f, 6.f, 8.f, 10.f, 20.f };
+	SimConfig config;
+	SimConfigDefault(&config);
+	printf("break-even chop rate: %.2f chops/s\n", SolverMinChopRate(&config));
+	printf("chops/s   predicted(s)   survival(s)   avg score   max score   dead   stuck\n");
+
+	bool isWinnable = true;
+	for (int i = 0; i < (int)(sizeof(chopRates) / sizeof(chopRates[0])); i++)
+	{
+		isWinnable &= RunSolverRate(&config, chopRates[i], _gameCount);
+	}
+
+	if (!isWinnable)
+	{
+		printf("error: the generator produced a column with no safe side\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+void RunSolverBatch(int _gameCount, int _stepCount)
+{
+	SimBatch batch;
+	if (!SimBatchCreate(&batch, _gameCount, DEFAULT_TRUNC_COUNT, DEFAULT_SEED))
+	{
+		printf("solver: allocation failed\n");
+		return;
+	}
+	SimBatchStart(&batch);
+
+	long long deadGames = 0;
+	clock_t start = clock();
+	for (int step = 0; step < _stepCount; step++)
+	{
+		SolverFillBatch(&batch);
+		SimBatchStep(&batch, SIM_DT);
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	for (int i = 0; i < batch.count; i++)
+	{
+		deadGames += batch.dead[i] != 0;
+	}
+
+	long long decisions = (long long)batch.count * _stepCount;
+	printf("solver (%s): %lld decisions, %lld games lost, %.3f s",
+		SimBatchPathName(batch.path), decisions, deadGames, seconds);
+	if (seconds > 0)
+	{
+		printf(", %.0f decisions/s", decisions / seconds);
+	}
+	printf("\n");
+
+	SimBatchDestroy(&batch);
+}
+
+bool RunSolverRate(const SimConfig* const _config, float _chopRate, int _gameCount)
+{
+	Simulation sim;
+	SolverPolicy policy;
+	Random random;
+	long long totalScore = 0;
+	int maxScore = 0;
+	int deadCount = 0;
+	int stuckCount = 0;
+	double totalSeconds = 0;
+	uint32_t maxTicks = SOLVER_MAX_SECONDS * SOLVER_TICK_RATE;
+	SolverFixedPolicy(&policy, _chopRate);
+	RandomSeed(&random, DEFAULT_SEED + 1);
+
+	for (int i = 0; i < _gameCount; i++)
+	{
+		// Every rate plays the same columns
+		SimSeed(&sim, DEFAULT_SEED, i);
+		SimReset(&sim, DEFAULT_TRUNC_COUNT);
+		SolverResult result = SolverPlay(&sim, &policy, &random, SOLVER_TICK_RATE, maxTicks);
+
+		totalScore += result.score;
+		totalSeconds += (double)result.ticks / SOLVER_TICK_RATE;
+		deadCount += result.isDead;
+		stuckCount += result.isStuck;
+		if (result.score > maxScore)
+		{
+			maxScore = result.score;
+		}
+	}
+
+	// What the life economy alone allows, capped at the length of a run
+	float predicted = SolverSurvivalTime(_config, _config->startLifeTime, _chopRate);
+	if (predicted < 0 || predicted > SOLVER_MAX_SECONDS)
+	{
+		predicted = SOLVER_MAX_SECONDS;
+	}
+	printf("%7.1f   %12.1f   %11.1f   %9.1f   %9d   %4d   %5d\n", _chopRate, predicted, totalSeconds / _gameCount,
+		(double)totalScore / _gameCount, maxScore, deadCount, stuckCount);
+	return stuckCount == 0;
+}
+
+int RunBalance(int argc, char** argv)
+{
+	long long gameCount = DEFAULT_BALANCE_GAMES;
+	int threadCount = ThreadHardwareCount();
+	uint64_t seed = DEFAULT_SEED;
+	float maxSeconds = DEFAULT_BALANCE_SECONDS;
+	int binWidth = DEFAULT_BIN_WIDTH;
+	const char* policyName = "all";
+	const char* format = "csv";
+	const char* outPath = NULL;
+
+	// Every rule constant takes a comma separated list, all combinations are played
+	float startLifeTimes[MAX_SWEEP_VALUES] = { START_LIFE_TIME };
+	float lifeBonuses[MAX_SWEEP_VALUES] = { LIFE_BONUS };
+	float maxLifeTimes[MAX_SWEEP_VALUES] = { MAX_LIFE_TIME };
+	float branchChances[MAX_SWEEP_VALUES] = { DEFAULT_BRANCH_CHANCE };
+	int startLifeCount = 1;
+	int lifeBonusCount = 1;
+	int maxLifeCount = 1;
+	int branchChanceCount = 1;
+
+	for (int i = 2; i < argc; i += 2)
+	{
+		// Every option takes a value, a misspelt one must not silently run with the defaults
+		if (i + 1 == argc)
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+		const char* value = argv[i + 1];
+		bool isParsed = true;
+		if (strcmp(argv[i], "--games") == 0)
+		{
+			isParsed = ParseCount(value, &gameCount);
+		}
+		else if (strcmp(argv[i], "--threads") == 0)
+		{
+			isParsed = ParseIntCount(value, &threadCount);
+		}
+		else if (strcmp(argv[i], "--seed") == 0)
+		{
+			isParsed = ParseSeed(value, &seed);
+		}
+		else if (strcmp(argv[i], "--max-seconds") == 0)
+		{
+			isParsed = ParseNumber(value, &maxSeconds) && maxSeconds > 0;
+		}
+		else if (strcmp(argv[i], "--bin-width") == 0)
+		{
+			isParsed = ParseIntCount(value, &binWidth);
+		}
+		else if (strcmp(argv[i], "--policy") == 0)
+		{
+			policyName = value;
+		}
+		else if (strcmp(argv[i], "--format") == 0)
+		{
+			format = value;
+			isParsed = strcmp(format, "csv") == 0 || strcmp(format, "json") == 0;
+		}
+		else if (strcmp(argv[i], "--out") == 0)
+		{
+			outPath = value;
+		}
+		else if (strcmp(argv[i], "--start-life") == 0)
+		{
+			startLifeCount = ParseList(value, startLifeTimes);
+			isParsed = startLifeCount > 0;
+		}
+		else if (strcmp(argv[i], "--life-bonus") == 0)
+		{
+			lifeBonusCount = ParseList(value, lifeBonuses);
+			isParsed = lifeBonusCount > 0;
+		}
+		else if (strcmp(argv[i], "--max-life") == 0)
+		{
+			maxLifeCount = ParseList(value, maxLifeTimes);
+			isParsed = maxLifeCount > 0;
+		}
+		else if (strcmp(argv[i], "--branch-chance") == 0)
+		{
+			branchChanceCount = ParseList(value, branchChances);
+			isParsed = branchChanceCount > 0;
+		}
+		else
+		{
+			isParsed = false;
+		}
+
+		if (!isParsed)
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	const SolverPolicy* policy = BalanceFindPolicy(policyName);
+	int policyCount = policy ? 1 : BalancePolicyCount();
+	if (!policy && strcmp(policyName, "all") != 0)
+	{
+		printf("Unknown policy %s\n", policyName);
+		return EXIT_FAILURE;
+	}
+
+	int runCount = startLifeCount * lifeBonusCount * maxLifeCount * branchChanceCount * policyCount;
+	BalanceResult* results = calloc(runCount, sizeof(BalanceResult));
+	if (!results)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Progress goes to stderr so that stdout only holds the data
+	fprintf(stderr, "%d runs of %lld games on %d threads\n", runCount, gameCount, threadCount);
+	int run = 0;
+	bool isValid = true;
+	for (int a = 0; a < startLifeCount; a++)
+	{
+		for (int b = 0; b < lifeBonusCount; b++)
+		{
+			for (int c = 0; c < maxLifeCount; c++)
+			{
+				for (int d = 0; d < branchChanceCount; d++)
+				{
+					for (int p = 0; p < policyCount && isValid; p++)
+					{
+						SimConfig config = { startLifeTimes[a], lifeBonuses[b], maxLifeTimes[c], branchChances[d] };
+						const SolverPolicy* runPolicy = policy ? policy : BalanceGetPolicy(p);
+						BalanceResult* result = &results[run];
+						isValid = BalanceRun(result, &config, runPolicy, gameCount, threadCount, seed, maxSeconds);
+						if (isValid)
+						{
+							fprintf(stderr, "%-8s life %g +%g max %g branch %g: mean %.1f, p50 %d, p99 %d, %.2f s, %.0f games/s\n",
+								runPolicy->name, config.startLifeTime, config.lifeBonus, config.maxLifeTime, config.branchChance,
+								result->totalScore / gameCount, BalancePercentile(result, 50), BalancePercentile(result, 99),
+								result->runSeconds, gameCount / result->runSeconds);
+							run++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	FILE* file = outPath ? FileOpen(outPath, "w") : stdout;
+	if (!isValid || !file)
+	{
+		printf(isValid ? "Could not write %s\n" : "Balance run failed\n", outPath);
+		isValid = false;
+	}
+	else
+	{
+		if (strcmp(format, "json") == 0)
+		{
+			BalanceWriteJson(file, results, run, binWidth);
+		}
+		else
+		{
+			BalanceWriteCsv(file, results, run, binWidth);
+		}
+		if (outPath)
+		{
+			fclose(file);
+		}
+	}
+
+	for (int i = 0; i < run; i++)
+	{
+		BalanceFree(&results[i]);
+	}
+	free(results);
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int ParseList(const char* _text, float* const _values)
+{
+	int count = 0;
+	char* end = NULL;
+	while (true)
+	{
+		// More values than MAX_SWEEP_VALUES fail rather than being dropped
+		if (count == MAX_SWEEP_VALUES)
+		{
+			return 0;
+		}
+		_values[count] = strtof(_text, &end);
+		if (end == _text)
+		{
+			return 0;
+		}
+		count++;
+		if (*end != ',')
+		{
+			break;
+		}
+		_text = end + 1;
+	}
+	return *end == '\0' ? count : 0;
+}
+
+bool ParseNumber(const char* _text, float* const _value)
+{
+	char* end = NULL;
+	float value = strtof(_text, &end);
+	if (end == _text || *end != '\0')
+	{
+		return false;
+	}
+	*_value = value;
+	return true;
+}
+
+bool ParseSeed(const char* _text, uint64_t* const _seed)
+{
+	// strtoull would wrap a negative seed around
+	char* end = NULL;
+	unsigned long long seed = strtoull(_text, &end, 10);
+	if (end == _text || *end != '\0' || _text[0] == '-')
+	{
+		return false;
+	}
+	*_seed = seed;
+	return true;
+}
+
+static void EmptyJob(JobSystem* _jobs, JobCounter* _counter, void* _data)
+{
+}
+
+static void SpawnJob(JobSystem* _jobs, JobCounter* _counter, void* _data)
+{
+	// Binary tree: every job but the leaves submits two children on the same counter
+	intptr_t depth = (intptr_t)_data;
+	if (depth > 0)
+	{
+		JobSubmit(_jobs, SpawnJob, (void*)(depth - 1), _counter);
+		JobSubmit(_jobs, SpawnJob, (void*)(depth - 1), _counter);
+	}
+}
+
+int RunJobBench(int _jobCount, int _workerCount)
+{
+	JobSystem jobs;
+	if (_jobCount < 1 || !JobSystemCreate(&jobs, _workerCount))
+	{
+		printf("jobs: invalid arguments\n");
+		return EXIT_FAILURE;
+	}
+	printf("workers: %d (including the main thread)\n", jobs.workerCount);
+
+	// Baseline: the same empty function through a pointer, no scheduler
+	void (*volatile function)(JobSystem*, JobCounter*, void*) = EmptyJob;
+	double start = TimerNow();
+	for (int i = 0; i < _jobCount; i++)
+	{
+		function(&jobs, NULL, NULL);
+	}
+	double directSeconds = TimerNow() - start;
+	printf("direct call: %.1f ns/call\n", directSeconds * 1e9 / _jobCount);
+
+	// Submit from the main thread in batches that fit the deque, then wait
+	JobCounter counter = { 0 };
+	start = TimerNow();
+	for (int submitted = 0; submitted < _jobCount; submitted += JOB_BATCH_COUNT)
+	{
+		for (int i = submitted; i < submitted + JOB_BATCH_COUNT && i < _jobCount; i++)
+		{
+			JobSubmit(&jobs, EmptyJob, NULL, &counter);
+		}
+		JobWait(&jobs, &counter);
+	}
+	double flatSeconds = TimerNow() - start;
+	printf("flat submit + wait: %.1f ns/job\n", flatSeconds * 1e9 / _jobCount);
+
+	// Recursive spawning, work is spread by stealing only
+	int depth = 0;
+	while (((2LL << (depth + 1)) - 1) <= _jobCount)
+	{
+		depth++;
+	}
+	long long treeCount = (2LL << depth) - 1;
+	start = TimerNow();
+	JobSubmit(&jobs, SpawnJob, (void*)(intptr_t)depth, &counter);
+	JobWait(&jobs, &counter);
+	double treeSeconds = TimerNow() - start;
+	printf("spawn tree: %lld jobs, %.1f ns/job\n", treeCount, treeSeconds * 1e9 / treeCount);
+
+	// A frame shaped graph: one phase, two in parallel after it, one joining them
+	JobPhase phases[] =
+	{
+		{ "simulate", EmptyJob, NULL, 0, { 0 } },
+		{ "hud", EmptyJob, NULL, 1 << 0, { 0 } },
+		{ "animate", EmptyJob, NULL, 1 << 0, { 0 } },
+		{ "draw", EmptyJob, NULL, (1 << 1) | (1 << 2), { 0 } },
+	};
+	start = TimerNow();
+	for (int i = 0; i < JOB_FRAME_COUNT; i++)
+	{
+		JobRunPhases(&jobs, phases, sizeof(phases) / sizeof(phases[0]));
+	}
+	double phaseSeconds = TimerNow() - start;
+	printf("phase graph: %.2f us/frame of %d phases\n", phaseSeconds * 1e6 / JOB_FRAME_COUNT,
+		(int)(sizeof(phases) / sizeof(phases[0])));
+
+	for (int i = 0; i < jobs.workerCount; i++)
+	{
+		printf("worker %d: %lld jobs, %lld stolen\n", i, jobs.workers[i].executedCount, jobs.workers[i].stolenCount);
+	}
+
+	JobSystemDestroy(&jobs);
+	return EXIT_SUCCESS;
+}
+#pragma endregion
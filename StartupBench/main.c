@@ -0,0 +1,416 @@
+#ifndef _WIN32
+// posix_spawn, posix_fadvise, opendir and sync are POSIX (sync from XSI), strict C modes hide them otherwise
+#define _XOPEN_SOURCE 700
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "AssetPack.h"
+#include "File.h"
+#include "Startup.h"
+#include "Timer.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+#pragma region Define
+#define DEFAULT_RUNS 10
+#define MAX_RUNS 256
+#define DEFAULT_OUTPUT "startup.json"
+// Written by the game, read back after every run
+#define RUN_REPORT "startup-run.txt"
+#ifdef _WIN32
+#define GAME_EXECUTABLE "Game.exe"
+#else
+#define GAME_EXECUTABLE "Game"
+#endif
+#pragma endregion
+
+#pragma region Struct and Enum
+typedef enum CacheMode
+{
+	// One launch first that is not measured, the files are then in the page cache
+	CACHE_WARM,
+	// The page cache is dropped before every launch
+	CACHE_COLD,
+}CacheMode;
+
+typedef enum CacheDrop
+{
+	DROP_NONE,
+	// Only the files of the game directory were evicted
+	DROP_FILES,
+	// The whole page cache, needs the rights for it
+	DROP_SYSTEM,
+}CacheDrop;
+
+typedef struct ModeResult
+{
+	CacheMode mode;
+	CacheDrop drop;
+	StartupRun runs[MAX_RUNS];
+	int runCount;
+	int failedCount;
+}ModeResult;
+#pragma endregion
+
+#pragma region Definition
+void RunMode(ModeResult* const _result, const char* _game, int _runCount);
+bool RunGame(const char* _game, StartupRun* const _run);
+CacheDrop DropCaches(const char* _directory);
+bool EvictFile(const char* _path);
+double Percentile(double* const _values, int _count, double _percentile);
+int CompareDouble(const void* _a, const void* _b);
+void PrintSummary(const ModeResult* const _result);
+void WriteJson(FILE* _file, const char* _game, const ModeResult* const _results, int _count);
+void WriteJsonString(FILE* _file, const char* _text);
+#pragma endregion
+
+#pragma region Core
+int main(int argc, char** argv)
+{
+	int runCount = DEFAULT_RUNS;
+	const char* outputPath = DEFAULT_OUTPUT;
+	const char* mode = "both";
+	char game[ASSET_PACK_PATH_LENGTH];
+	AssetPackPath(game, sizeof(game), GAME_EXECUTABLE);
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+		{
+			runCount = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+		{
+			mode = argv[++i];
+		}
+		else if (strcmp(argv[i], "--game") == 0 && i + 1 < argc)
+		{
+			snprintf(game, sizeof(game), "%s", argv[++i]);
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			outputPath = argv[++i];
+		}
+		else
+		{
+			printf("usage: StartupBench [--runs %d] [--mode warm|cold|both] [--game <executable>] [--out %s]\n", DEFAULT_RUNS, DEFAULT_OUTPUT);
+			printf("Launches the game with --startup-report until it reaches the menu and writes the timings as JSON\n");
+			return EXIT_FAILURE;
+		}
+	}
+	runCount = runCount < 1 ? 1 : runCount > MAX_RUNS ? MAX_RUNS : runCount;
+
+	// Cold first: a warm run would only fill the cache the cold one then has to drop
+	static ModeResult results[2];
+	int resultCount = 0;
+	if (strcmp(mode, "cold") == 0 || strcmp(mode, "both") == 0)
+	{
+		results[resultCount].mode = CACHE_COLD;
+		RunMode(&results[resultCount++], game, runCount);
+	}
+	if (strcmp(mode, "warm") == 0 || strcmp(mode, "both") == 0)
+	{
+		results[resultCount].mode = CACHE_WARM;
+		RunMode(&results[resultCount++], game, runCount);
+	}
+
+	bool isValid = resultCount > 0;
+	for (int i = 0; i < resultCount; i++)
+	{
+		PrintSummary(&results[i]);
+		isValid = isValid && results[i].runCount > 0;
+	}
+
+	FILE* file = FileOpen(outputPath, "w");
+	if (!file)
+	{
+		printf("Could not write %s\n", outputPath);
+		return EXIT_FAILURE;
+	}
+	WriteJson(file, game, results, resultCount);
+	fclose(file);
+	printf("Written to %s\n", outputPath);
+	return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void RunMode(ModeResult* const _result, const char* _game, int _runCount)
+{
+	// The files to evict are next to the game: the executable, its libraries and the asset pack
+	char directory[ASSET_PACK_PATH_LENGTH];
+	const char* slash = strrchr(_game, '/');
+	const char* backslash = strrchr(_game, '\\');
+	slash = backslash > slash ? backslash : slash;
+	snprintf(directory, sizeof(directory), "%.*s", slash ? (int)(slash - _game) : 1, slash ? _game : ".");
+
+	if (_result->mode == CACHE_WARM)
+	{
+		StartupRun ignored;
+		RunGame(_game, &ignored);
+	}
+	for (int i = 0; i < _runCount; i++)
+	{
+		if (_result->mode == CACHE_COLD)
+		{
+			_result->drop = DropCaches(directory);
+		}
+		if (RunGame(_game, &_result->runs[_result->runCount]))
+		{
+			_result->runCount++;
+		}
+		else
+		{
+			_result->failedCount++;
+		}
+	}
+}
+
+bool RunGame(const char* _game, StartupRun* const _run)
+{
+	remove(RUN_REPORT);
+	char origin[32];
+	// Same clock as the game: QueryPerformanceCounter and CLOCK_MONOTONIC are shared by every process
+	snprintf(origin, sizeof(origin), "%lld", (long long)TimerTicks());
+#ifdef _WIN32
+	char commandLine[ASSET_PACK_PATH_LENGTH + 128];
+	snprintf(commandLine, sizeof(commandLine), "\"%s\" --startup-report %s --startup-origin %s", _game, RUN_REPORT, origin);
+	STARTUPINFOA startupInfo = { sizeof(startupInfo) };
+	PROCESS_INFORMATION process;
+	if (!CreateProcessA(NULL, commandLine, NULL, NULL, FALSE, 0, NULL, NULL, &startupInfo, &process))
+	{
+		printf("Could not launch %s\n", _game);
+		return false;
+	}
+	WaitForSingleObject(process.hProcess, INFINITE);
+	CloseHandle(process.hThread);
+	CloseHandle(process.hProcess);
+#else
+	char* arguments[] = { (char*)_game, "--startup-report", RUN_REPORT, "--startup-origin", origin, NULL };
+	pid_t process;
+	if (posix_spawn(&process, _game, NULL, NULL, arguments, environ) != 0)
+	{
+		printf("Could not launch %s\n", _game);
+		return false;
+	}
+	int status;
+	waitpid(process, &status, 0);
+#endif
+
+	// A run that never reached the menu (missing pack, closed window) is not a timing
+	bool isValid = StartupReadRun(_run, RUN_REPORT) && _run->milestones[STARTUP_INTERACTIVE] >= 0;
+	remove(RUN_REPORT);
+	return isValid;
+}
+#pragma endregion
+
+CacheDrop DropCaches(const char* _directory)
+{
+#ifndef _WIN32
+	// Everything, shared libraries included, but only root may
+	sync();
+	FILE* dropFile = FileOpen("/proc/sys/vm/drop_caches", "w");
+	if (dropFile)
+	{
+		bool isDropped = fputs("1\n", dropFile) >= 0;
+		isDropped = fclose(dropFile) == 0 && isDropped;
+		if (isDropped)
+		{
+			return DROP_SYSTEM;
+		}
+	}
+#endif
+
+	int evictedCount = 0;
+#ifdef _WIN32
+	char pattern[ASSET_PACK_PATH_LENGTH];
+	snprintf(pattern, sizeof(pattern), "%s\\*", _directory);
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA(pattern, &data);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return DROP_NONE;
+	}
+	do
+	{
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			continue;
+		}
+		const char* name = data.cFileName;
+#else
+	DIR* directory = opendir(_directory);
+	if (!directory)
+	{
+		return DROP_NONE;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(directory)) != NULL)
+	{
+		const char* name = entry->d_name;
+#endif
+		char path[ASSET_PACK_PATH_LENGTH];
+		snprintf(path, sizeof(path), "%s/%s", _directory, name);
+		evictedCount += EvictFile(path);
+#ifdef _WIN32
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	}
+	closedir(directory);
+#endif
+	return evictedCount ? DROP_FILES : DROP_NONE;
+}
+
+bool EvictFile(const char* _path)
+{
+#ifdef _WIN32
+	// Opening a file unbuffered makes the cache manager flush and purge its cached pages
+	HANDLE file = CreateFileA(_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+		OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	CloseHandle(file);
+	return true;
+#else
+	struct stat status;
+	if (stat(_path, &status) != 0 || !S_ISREG(status.st_mode))
+	{
+		return false;
+	}
+	int file = open(_path, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	bool isEvicted = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+	return isEvicted;
+#endif
+}
+
+double Percentile(double* const _values, int _count, double _percentile)
+{
+	if (_count == 0)
+	{
+		return -1;
+	}
+	qsort(_values, _count, sizeof(double), CompareDouble);
+	int index = (int)(_percentile / 100.0 * (_count - 1) + 0.5);
+	return _values[index];
+}
+
+int CompareDouble(const void* _a, const void* _b)
+{
+	double a = *(const double*)_a;
+	double b = *(const double*)_b;
+	return (a > b) - (a < b);
+}
+
+void PrintSummary(const ModeResult* const _result)
+{
+	static const char* dropNames[] = { "none", "files", "system" };
+	printf("%s start, %d runs (%d failed), cache dropped: %s\n", _result->mode == CACHE_COLD ? "cold" : "warm",
+		_result->runCount, _result->failedCount, _result->mode == CACHE_COLD ? dropNames[_result->drop] : "-");
+	for (int milestone = 0; milestone < STARTUP_MILESTONE_COUNT; milestone++)
+	{
+		double values[MAX_RUNS];
+		for (int i = 0; i < _result->runCount; i++)
+		{
+			values[i] = _result->runs[i].milestones[milestone];
+		}
+		double median = Percentile(values, _result->runCount, 50);
+		printf("  %-14s median %8.1f ms  min %8.1f  max %8.1f\n", StartupMilestoneName(milestone), median,
+			_result->runCount ? values[0] : -1, _result->runCount ? values[_result->runCount - 1] : -1);
+	}
+}
+
+void WriteJson(FILE* _file, const char* _game, const ModeResult* const _results, int _count)
+{
+	static const char* dropNames[] = { "none", "files", "system" };
+	static const double percentiles[] = { 0, 50, 90, 100 };
+	static const char* percentileNames[] = { "min", "median", "p90", "max" };
+	fprintf(_file, "{\n\t\"game\": ");
+	WriteJsonString(_file, _game);
+	fprintf(_file, ",\n\t\"modes\": [");
+	for (int m = 0; m < _count; m++)
+	{
+		const ModeResult* result = &_results[m];
+		fprintf(_file, "%s\n\t\t{\n\t\t\t\"mode\": \"%s\",\n\t\t\t\"cacheDrop\": \"%s\",\n\t\t\t\"runs\": %d,\n\t\t\t\"failed\": %d,\n",
+			m ? "," : "", result->mode == CACHE_COLD ? "cold" : "warm", dropNames[result->drop], result->runCount, result->failedCount);
+
+		// Milestones, from the launch
+		fprintf(_file, "\t\t\t\"milestonesMs\": {");
+		double values[MAX_RUNS];
+		for (int milestone = 0; milestone < STARTUP_MILESTONE_COUNT; milestone++)
+		{
+			fprintf(_file, "%s\n\t\t\t\t\"%s\": {", milestone ? "," : "", StartupMilestoneName(milestone));
+			for (int p = 0; p < (int)(sizeof(percentiles) / sizeof(percentiles[0])); p++)
+			{
+				for (int i = 0; i < result->runCount; i++)
+				{
+					values[i] = result->runs[i].milestones[milestone];
+				}
+				fprintf(_file, "%s\"%s\": %.3f", p ? ", " : " ", percentileNames[p], Percentile(values, result->runCount, percentiles[p]));
+			}
+			fprintf(_file, " }");
+		}
+
+		// Medians per asset, the assets are in the same order in every run
+		fprintf(_file, "\n\t\t\t},\n\t\t\t\"assetsMedianMs\": [");
+		int assetCount = result->runCount ? result->runs[0].assetCount : 0;
+		for (int a = 0; a < assetCount; a++)
+		{
+			double medians[3];
+			for (int field = 0; field < 3; field++)
+			{
+				for (int i = 0; i < result->runCount; i++)
+				{
+					const StartupAsset* asset = &result->runs[i].assets[a];
+					values[i] = field == 0 ? asset->ioMs : field == 1 ? asset->decodeMs : asset->uploadMs;
+				}
+				medians[field] = Percentile(values, result->runCount, 50);
+			}
+			fprintf(_file, "%s\n\t\t\t\t{ \"name\": ", a ? "," : "");
+			WriteJsonString(_file, result->runs[0].assets[a].name);
+			fprintf(_file, ", \"io\": %.3f, \"decode\": %.3f, \"upload\": %.3f }", medians[0], medians[1], medians[2]);
+		}
+
+		// Every run, for whoever wants their own statistics
+		fprintf(_file, "\n\t\t\t],\n\t\t\t\"samples\": [");
+		for (int i = 0; i < result->runCount; i++)
+		{
+			fprintf(_file, "%s\n\t\t\t\t{", i ? "," : "");
+			for (int milestone = 0; milestone < STARTUP_MILESTONE_COUNT; milestone++)
+			{
+				fprintf(_file, "%s\"%s\": %.3f", milestone ? ", " : " ", StartupMilestoneName(milestone), result->runs[i].milestones[milestone]);
+			}
+			fprintf(_file, " }");
+		}
+		fprintf(_file, "\n\t\t\t]\n\t\t}");
+	}
+	fprintf(_file, "\n\t]\n}\n");
+}
+
+void WriteJsonString(FILE* _file, const char* _text)
+{
+	fputc('"', _file);
+	for (const char* c = _text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			fputc('\\', _file);
+		}
+		fputc(*c, _file);
+	}
+	fputc('"', _file);
+}